@@ -0,0 +1,117 @@
+#include "amvif08.hpp"
+#include "rtu.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Benchmark of the voltage read path.
+   Without arguments only CRC16 throughput is measured, which runs on
+   any host. With a serial port, AMVIF08 voltage reads through libmodbus
+   and through the in-house RTU framing are timed on the real bus.
+*/
+
+using namespace std::chrono;
+
+#define CRC_BYTES (1 << 20)
+#define CRC_ROUNDS 64
+#define FRAME_BYTES 11          // Response of 4 registers, without CRC
+
+// Reference: one bit at a time.
+static uint16_t bitwiseCRC(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+template <class F>
+static double timeCRC(F crc, const std::vector<uint8_t> &data, size_t len,
+                      uint16_t &check) {
+    size_t rounds = CRC_ROUNDS * (CRC_BYTES / len);
+    auto start = steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        check ^= crc(&data[(r * len) % (CRC_BYTES - len)], len);
+    }
+    return duration<double, std::nano>(steady_clock::now() - start).count()
+           / rounds;
+}
+
+static void benchCRC() {
+    std::vector<uint8_t> data(CRC_BYTES);
+    for (auto &b : data) {
+        b = rand();
+    }
+    uint16_t check = 0;
+    size_t sizes[] = {FRAME_BYTES, 64, CRC_BYTES / 16};
+
+    printf("CRC16\t\tbytes\tbitwise ns\tslice-by-8 ns\tspeedup\n");
+    for (size_t len : sizes) {
+        double bitwise = timeCRC(bitwiseCRC, data, len, check);
+        double sliced = timeCRC([](const uint8_t *d, size_t n) {
+            return rtuCRC(d, n);
+        }, data, len, check);
+        printf("\t\t%zu\t%.1f\t\t%.1f\t\t%.1fx\n",
+               len, bitwise, sliced, bitwise / sliced);
+    }
+    if (rtuCRC(data.data(), 4096) != bitwiseCRC(data.data(), 4096)) {
+        printf("CRC mismatch!\n");
+    }
+    // Both methods fold into check, so it cancels to 0 when they agree.
+    printf("(checksum xor %04x)\n", check);
+}
+
+static void benchReads(AMVIF08 &adc, bool fast, int reads) {
+    std::vector<double> latency;
+    uint16_t raw[4];
+    int failed = 0;
+
+    adc.setFastRead(fast);
+    auto start = steady_clock::now();
+    for (int i = 0; i < reads; i++) {
+        auto t0 = steady_clock::now();
+        if (adc.readVoltageRaw(1, 4, raw) < 0) {
+            failed++;
+            continue;
+        }
+        latency.push_back(duration<double, std::milli>(
+            steady_clock::now() - t0).count());
+    }
+    double total = duration<double>(steady_clock::now() - start).count();
+
+    std::sort(latency.begin(), latency.end());
+    double mean = 0;
+    for (double l : latency) {
+        mean += l;
+    }
+    size_t n = latency.size();
+    printf("%s\t%d\t%.2f\t%.2f\t%.2f\t%.1f\n",
+           fast ? "rtu     " : "libmodbus", failed,
+           n ? mean / n : 0.0,
+           n ? latency[n / 2] : 0.0,
+           n ? latency[n * 99 / 100] : 0.0,
+           reads / total);
+}
+
+int main(int argc, char *argv[]) {
+    benchCRC();
+    if (argc < 2) {
+        return 0;
+    }
+
+    int reads = argc > 2 ? atoi(argv[2]) : 500;
+    AMVIF08 adc;
+    if (adc.connect(argv[1]) < 0) {
+        fprintf(stderr, "Cannot connect to %s\n", argv[1]);
+        return 1;
+    }
+    printf("\nRead 4 ch\tfailed\tmean ms\tp50 ms\tp99 ms\treads/s\n");
+    benchReads(adc, false, reads);
+    benchReads(adc, true, reads);
+    return 0;
+}
@@ -1,10 +1,10 @@
 #ifndef AMVIF08_H
 #define AMVIF08_H
+#include "rtu.hpp"
 #include <cstdint>
 #include <modbus/modbus.h>
 #include <vector>
 #include <string>
-#endif
 #define R4AVA07LIB_VERSION "1.0.0"
 
 class AMVIF08 {
@@ -14,8 +14,10 @@ class AMVIF08 {
     std::string name = "AMVIF08";
     unsigned short prod_id = 2048;
     short return_time;
-    short baudrate;
+    uint32_t baudrate;
     char parity;
+    RtuMaster rtu;          // Voltage reads, libmodbus for the rest
+    bool fast_read = true;
 
   protected:
     // Check if channel is in range 1-8
@@ -30,6 +32,13 @@ class AMVIF08 {
     // Return channel's voltage ratio
     std::vector<float> getVoltageRatio(uint16_t ch,
                                        uint8_t number = 0x01);
+    // Read channel's voltage into a caller-owned buffer.
+    // Return number of values read, -1 on failure.
+    int readVoltage(uint16_t ch, uint8_t number, float *voltage);
+    // Read channel's raw voltage registers (10 mV units).
+    int readVoltageRaw(uint16_t ch, uint8_t number, uint16_t *raw);
+    // Return channel's voltage ratio into a caller-owned buffer.
+    int getVoltageRatio(uint16_t ch, uint8_t number, float *ratio);
     // Return device name
     std::string getName()         { return name; }
     // Return product's ID
@@ -39,9 +48,11 @@ class AMVIF08 {
     // Return slave's address
     uint8_t getAddr()             { return modbus_get_slave(ctx); };
     // Return current baud rate
-    short getBaud()               { return baudrate; }
+    uint32_t getBaud()            { return baudrate; }
     // Return parity type
     char getParity()              { return parity; }
+    // Switch voltage reads between in-house RTU framing and libmodbus
+    void setFastRead(bool enable) { fast_read = enable; }
 
     // Set channel's voltage ratio
     short setVoltageRatio(uint16_t ch, float ratio);
@@ -52,7 +63,8 @@ class AMVIF08 {
     // Set slave's address
     short setAddr(uint16_t new_addr);
     // Change serial  baud rate
-    short setBaudRate(unsigned short baud = 9600);
+    short setBaudRate(uint32_t baud = 9600);
     // Change parity check type
     short setParity(char type);
-};
\ No newline at end of file
+};
+#endif
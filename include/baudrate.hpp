@@ -0,0 +1,20 @@
+#ifndef BAUDRATE_H
+#define BAUDRATE_H
+#include <cstdint>
+
+// Serial baud rates shared by the Modbus collectors. The position of a
+// rate in the table is the code written to the collector's baud register.
+static const uint32_t BAUDRATES[] = {
+    1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200
+};
+
+// Return register code of a baud rate, -1 if not supported (up to max_code).
+inline int baudCode(uint32_t baud, int max_code) {
+    for (int code = 0; code <= max_code; code++) {
+        if (BAUDRATES[code] == baud) {
+            return code;
+        }
+    }
+    return -1;
+}
+#endif
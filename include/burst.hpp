@@ -0,0 +1,65 @@
+#ifndef BURST_H
+#define BURST_H
+#include "amvif08.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define BURST_MAGIC "VB"
+#define BURST_VERSION 1
+
+/* Burst acquisition of selected channels at maximum bus rate.
+   All buffers are allocated by the constructor; a capture fills them
+   back-to-back for the requested window and encode() packs it into one
+   delta/varint compressed block:
+
+   | "VB" | version | channel mask | frames (varint) | start (8 bytes, ms) |
+   | frame stamps, delta us (varint) | per channel raw deltas (zigzag varint) |
+
+   Raw values are AMVIF08 voltage registers in 10 mV units.
+*/
+class Burst {
+  private:
+    int channels;
+    size_t max_frames;
+    unsigned max_window;            // Longest capture in ms
+    std::vector<uint16_t> samples;  // Frame-major, `channels` per frame
+    std::vector<uint32_t> stamps;   // Microseconds since capture start
+    std::vector<uint8_t> block;     // Encoded capture
+    size_t frames = 0;
+    size_t block_size = 0;
+    uint64_t start_ms = 0;
+    unsigned mask = 0;
+
+    std::mutex request_mutex;
+    unsigned request_mask = 0;
+    unsigned request_window = 0;
+
+  public:
+    // Allocate buffers for up to max_frames frames of `channels` channels.
+    // A capture blocks acquisition, so it never runs past max_window ms.
+    Burst(int channels, size_t max_frames, unsigned max_window);
+    // Request a capture of channels in mask (bit 0 = CH1) for window_ms.
+    // Requests made before the capture starts are merged.
+    // Return 0 on success, -1 if mask or window is out of range.
+    int trigger(unsigned mask, unsigned window_ms);
+    // Return longest capture window in ms
+    unsigned getMaxWindow()     { return max_window; }
+    // Return true if a capture was requested
+    bool pending();
+    // Drop the requested capture
+    void cancel();
+    // Run the requested capture, return number of frames captured.
+    int capture(AMVIF08 &adc);
+    // Encode last capture, return block size in bytes.
+    size_t encode();
+
+    // Return encoded block
+    const uint8_t *getBlock()   { return block.data(); }
+    // Return number of frames in last capture
+    size_t getFrames()          { return frames; }
+    // Return channel mask of last capture
+    unsigned getMask()          { return mask; }
+};
+#endif
@@ -0,0 +1,53 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+#include <cmath>
+
+// Event flags returned by Detector::update().
+enum DetectorEvent {
+    EVENT_NONE = 0x00,
+    EVENT_RATE = 0x01,  // Rate of change over limit
+    EVENT_RISE = 0x02,  // Upward level shift (CUSUM)
+    EVENT_DROP = 0x04,  // Downward level shift (CUSUM)
+};
+
+/* Streaming change detector running in O(1) time and memory per sample.
+   Keeps a Welford mean/variance that forgets with a horizon of `window`
+   samples, the rate of change smoothed over `horizon` seconds and a
+   two-sided CUSUM of the standardized residual. Smoothing over a fixed
+   time keeps a single ADC step from reading as a fast change however
+   short the sampling period is.
+*/
+class Detector {
+  private:
+    float rate_limit;   // Rate of change limit, in units per second
+    float drift;        // CUSUM allowance, in standard deviations
+    float threshold;    // CUSUM decision level, in standard deviations
+    float min_std;      // Standard deviation floor for stable signals
+    unsigned window;    // Statistics horizon, in samples
+    float horizon;      // Rate smoothing time constant, in seconds
+    unsigned n = 0;
+    double mean = 0;
+    double var = 0;
+    float last = NAN;
+    float rate = 0;
+    float cusum_pos = 0;
+    float cusum_neg = 0;
+
+  public:
+    Detector(float rate_limit, float min_std,
+             float drift = 0.5, float threshold = 5.0,
+             unsigned window = 60, float horizon = 1.0);
+    // Feed a sample taken dt seconds after the previous one.
+    // Return a combination of DetectorEvent flags.
+    int update(float value, float dt);
+    // Forget all statistics.
+    void reset();
+
+    // Return running mean
+    float getMean()   { return mean; }
+    // Return running standard deviation
+    float getStdDev() { return std::sqrt(var); }
+    // Return smoothed rate of change per second
+    float getRate()   { return rate; }
+};
+#endif
@@ -0,0 +1,30 @@
+#ifndef HEAPGUARD_H
+#define HEAPGUARD_H
+#include <cstddef>
+
+/* Heap usage guard for the static-memory profile (BUILD=static).
+   Every buffer is allocated during initialization. The C allocator is
+   interposed, for this code as well as libmosquitto and libmodbus, and
+   the bytes live on the heap are tracked from malloc to free. Once
+   seal() is called, the live bytes are compared with the value at seal:
+   short-lived allocations such as a publish cancel out, while a leak or
+   a growing buffer shows up as net growth long before RSS does on the
+   board. Needs glibc.
+*/
+
+namespace heapguard {
+    // Mark the end of initialization.
+    void seal();
+    // Return number of allocations made after seal().
+    unsigned long getCount();
+    // Return bytes currently allocated on the heap.
+    long getLive();
+    // Return net heap growth in bytes since seal().
+    long getGrowth();
+    // Return resident set size in kB, -1 on failure.
+    long getRSS();
+    // Return net growth if it passed its previous high since seal(),
+    // else 0. Growth that was already reported is not reported again.
+    long checkGrowth();
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef LOG_H
+#define LOG_H
+#include "queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <semaphore.h>
+
+#define LOG_LINE_MAX 192
+
+struct LogLine {
+    bool error;
+    char text[LOG_LINE_MAX];
+};
+
+/* Asynchronous, rate-limited console log.
+   print() and error() format into a bounded lock-free queue and return
+   at once; flush(), called from a non-critical thread, writes at most
+   `rate` lines per second and reports lines dropped when the queue was
+   full. A writer thread can block in wait() until there is something to
+   flush, so an idle log costs no wakeups.
+*/
+class Log {
+  private:
+    BoundedQueue<LogLine> lines;
+    std::atomic<unsigned long> dropped;
+    unsigned long reported = 0;
+    int rate;
+    double tokens;
+    std::chrono::steady_clock::time_point last;
+    sem_t ready;                // Posted when a line is queued or dropped
+
+    // Queue a formatted line.
+    void queue(bool error, const char *format, va_list args);
+
+  public:
+    // Allocate room for capacity lines, written at most rate per second.
+    Log(size_t capacity, int rate);
+    ~Log();
+    // Queue a line for stdout without blocking.
+    void print(const char *format, ...)
+        __attribute__((format(printf, 2, 3)));
+    // Queue a line for stderr without blocking.
+    void error(const char *format, ...)
+        __attribute__((format(printf, 2, 3)));
+    // Write queued lines the rate allows, return number written.
+    int flush();
+    // Block until a line is queued or dropped.
+    void wait();
+    // Return true if lines are waiting to be written
+    bool pending()              { return lines.empty() == false; }
+};
+#endif
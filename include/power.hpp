@@ -0,0 +1,33 @@
+#ifndef POWER_H
+#define POWER_H
+#include <chrono>
+#include <cstddef>
+
+/* Wakeup and activity accounting of the whole process.
+   Wakeups are counted from voluntary context switches of all threads,
+   active time from the begin/end marks of the acquisition windows.
+*/
+class PowerStats {
+  private:
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point active_start;
+    std::chrono::steady_clock::duration active;
+    long switches = 0;
+    double cpu = 0;
+    bool in_active = false;
+
+  public:
+    PowerStats() { reset(); }
+    // Start a new report period.
+    void reset();
+    // Mark the start of an active window.
+    void beginActive();
+    // Mark the end of an active window.
+    void endActive();
+    // Return seconds since the report period started
+    double getElapsed();
+    // Write the period's figures as JSON, then start a new period.
+    // Return message length, -1 if it does not fit.
+    int report(const char *mode, char *msg, size_t size);
+};
+#endif
@@ -0,0 +1,117 @@
+#ifndef PUBLISHER_H
+#define PUBLISHER_H
+#include "queue.hpp"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <semaphore.h>
+#include <vector>
+#include <mosquittopp.h>
+
+#define PUBLISH_PAYLOAD_MAX 128
+
+// Priority lanes, events are always sent ahead of routine readings.
+enum class Lane {
+    event,
+    routine,
+};
+
+// What a lane does with new messages while the uplink is backed up.
+enum class Overflow {
+    drop_newest,    // Refuse new messages once the lane is full
+    drop_oldest,    // Make room by dropping the oldest queued message
+    coalesce,       // Keep only the newest message of each topic
+};
+
+struct PublishMessage {
+    const char *topic;      // Must outlive the message, e.g. a literal
+    int qos;
+    int len;
+    char payload[PUBLISH_PAYLOAD_MAX];
+};
+
+/* Publish stage between sensor conversion and MQTT.
+   Producers only copy their message into a bounded lock-free lane and
+   never wait on the broker. A single consumer drains the lanes through
+   drain(), keeping at most `window` QoS 1/2 messages unacknowledged.
+   Nothing is handed to the client while it is disconnected, since the
+   client would queue QoS 1/2 messages without bound; they stay in the
+   lanes under their overflow policy instead. Blocks too large for a lane
+   go through publishBlock(), one unacknowledged block at a time.
+*/
+class Publisher {
+  private:
+    BoundedQueue<PublishMessage> events;
+    BoundedQueue<PublishMessage> routine;
+    Overflow event_policy;
+    Overflow routine_policy;
+
+    // Consumer side only.
+    std::vector<PublishMessage> latest;     // Coalesced routine messages
+    size_t latest_used = 0;
+
+    std::atomic<bool> connected;
+    std::mutex inflight_mutex;
+    std::vector<int> inflight;              // Message ids awaiting ack
+    std::vector<int> early;                 // Acks that beat track()
+    size_t window;
+    int block_mid = 0;                      // Block awaiting ack, 0 if none
+
+    sem_t ready;                            // Posted when there is work
+
+    std::atomic<unsigned long> sent;
+    std::atomic<unsigned long> dropped;
+    std::atomic<unsigned long> coalesced;
+
+    // Queue into a lane under its policy.
+    int enqueue(BoundedQueue<PublishMessage> &lane, Overflow policy,
+                const PublishMessage &message);
+    // Keep message as its topic's newest coalesced value.
+    void coalesce(const PublishMessage &message);
+    // Take the next message to send, by priority.
+    bool next(PublishMessage &message);
+    // Return true if the in-flight window has room.
+    bool hasRoom();
+    // Count message mid as in flight until acknowledged.
+    void track(int mid);
+    // Remove mid from early acks, return true if it was there.
+    bool takeEarly(int mid);
+    // Wake a consumer blocked in wait().
+    void notify();
+
+  public:
+    // Allocate lanes, coalescing slots and the in-flight window.
+    Publisher(size_t event_slots, size_t routine_slots, size_t topics,
+              size_t window, Overflow event_policy, Overflow routine_policy);
+    ~Publisher();
+    // Queue a message without blocking. Return 0 if queued, 1 if an older
+    // message was dropped for it, -1 if it was dropped itself.
+    int push(Lane lane, const char *topic, const char *payload, int len,
+             int qos);
+    // Send queued messages while connected and the window has room,
+    // return number sent.
+    int drain(mosqpp::mosquittopp &client);
+    // Send a block of any size if connected and no earlier block awaits
+    // its ack. Return 0 if sent, -1 if refused.
+    int publishBlock(mosqpp::mosquittopp &client, const char *topic,
+                     const void *data, int len, int qos);
+    // Return true if publishBlock() would accept a block now.
+    bool canPublishBlock();
+    // Block until a message or an ack arrives, or timeout_ms passes.
+    void wait(int timeout_ms);
+    // Confirm delivery of message mid, from on_publish().
+    void acknowledge(int mid);
+    // Record connection state, from on_connect() and on_disconnect().
+    // Unacknowledged lane messages are forgotten on disconnect.
+    void setConnected(bool up);
+
+    // Return true while the client is connected
+    bool isConnected()            { return connected.load(); }
+    // Return number of messages handed to the client
+    unsigned long getSent()       { return sent.load(); }
+    // Return number of messages dropped under backpressure
+    unsigned long getDropped()    { return dropped.load(); }
+    // Return number of messages replaced by a newer one of their topic
+    unsigned long getCoalesced()  { return coalesced.load(); }
+};
+#endif
@@ -0,0 +1,91 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Bounded lock-free multi-producer/multi-consumer queue (Vyukov).
+   Capacity is rounded up to a power of two and allocated once; push()
+   and pop() never block and fail instead when full or empty.
+*/
+template <class T>
+class BoundedQueue {
+  private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail;   // Next cell to push
+    alignas(64) std::atomic<size_t> head;   // Next cell to pop
+
+  public:
+    BoundedQueue(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Append a copy of item, return false if full.
+    bool push(const T &item) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+                    cell.data = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Remove the oldest item into item, return false if empty.
+    bool pop(T &item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+                    item = cell.data;
+                    cell.seq.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Return true if nothing is queued. Pushes still in progress count
+    // as queued; the answer may be stale by the time it is used.
+    bool empty() {
+        return head.load(std::memory_order_acquire)
+            == tail.load(std::memory_order_acquire);
+    }
+
+    // Return queue capacity
+    size_t capacity() { return mask + 1; }
+};
+#endif
@@ -4,7 +4,6 @@
 #include <vector>
 #include <string>
 #include <modbus/modbus.h>
-#endif
 #define R4AVA07LIB_VERSION "1.0.0"
 
 class R4AVA07 {
@@ -28,6 +27,11 @@ class R4AVA07 {
     std::vector<float> readVoltage(uint16_t ch, uint8_t number = 0x01);
     // Return channel's voltage ratio
     std::vector<float> getVoltageRatio(uint16_t ch, uint8_t number = 0x01);
+    // Read channel's voltage into a caller-owned buffer.
+    // Return number of values read, -1 on failure.
+    int readVoltage(uint16_t ch, uint8_t number, float *voltage);
+    // Return channel's voltage ratio into a caller-owned buffer.
+    int getVoltageRatio(uint16_t ch, uint8_t number, float *ratio);
 
     // Set slave's ID
     int setID(short new_id);
@@ -37,4 +41,5 @@ class R4AVA07 {
     int setBaudRate(uint16_t baud);
     // Reset serial baud rate
     void resetBaud();
-};
\ No newline at end of file
+};
+#endif
@@ -0,0 +1,111 @@
+#ifndef RTU_H
+#define RTU_H
+#include <cstddef>
+#include <cstdint>
+
+/* Lean Modbus RTU master for the acquisition hot path.
+   Requests and responses are framed in-house: CRC16 is computed
+   slice-by-8, received bytes land in a ring buffer straight from the
+   serial descriptor and are parsed in place. A response is complete once
+   its expected length has arrived with a valid CRC; the UART and tty hand
+   bytes over in bursts, so gaps between them are only bounded by a
+   generous byte timeout. The 3.5 character silence of the baud rate is
+   kept before each request. A transaction is a
+   non-blocking state machine advanced by poll(); readRegisters() runs
+   one to completion for callers that just want to block.
+   Configuration commands stay with libmodbus on the same descriptor.
+*/
+
+#define RTU_FRAME_MAX 256
+#define RTU_RING_SIZE 512       // Power of two, holds two frames
+
+// Return Modbus CRC16 of data, continuing from crc.
+uint16_t rtuCRC(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+// Receive buffer that the descriptor reads into and the parser reads from.
+class RtuRing {
+  private:
+    uint8_t buf[RTU_RING_SIZE];
+    size_t head = 0;            // Next byte to parse
+    size_t tail = 0;            // Next byte to fill
+
+  public:
+    // Read available bytes from fd, return count, 0 if none, -1 on error.
+    int fill(int fd);
+    // Return number of unparsed bytes
+    size_t size()                 { return tail - head; }
+    // Return unparsed byte at offset i
+    uint8_t at(size_t i)          { return buf[(head + i) & (RTU_RING_SIZE - 1)]; }
+    // Return big-endian word at offset i
+    uint16_t word(size_t i)       { return at(i) << 8 | at(i + 1); }
+    // Return CRC16 of the first len unparsed bytes
+    uint16_t crc(size_t len);
+    // Drop the first len unparsed bytes.
+    void consume(size_t len)      { head += len; }
+    void clear()                  { head = tail = 0; }
+};
+
+enum class RtuState {
+    idle,       // No transaction
+    sending,    // Request partly written
+    waiting,    // Waiting for the response
+    done,       // Response received, registers available
+    failed,     // Timeout, CRC, exception or I/O error
+};
+
+class RtuMaster {
+  private:
+    int fd = -1;
+    uint8_t addr = 1;
+    uint32_t char_us = 0;       // One character time
+    uint32_t silence_us = 0;    // Inter-frame silence (t3.5)
+    uint32_t timeout_us;        // Response timeout after the request
+    uint32_t byte_timeout_us;   // Longest gap within a response
+    RtuState state = RtuState::idle;
+    int error = 0;
+
+    uint8_t request[8];
+    size_t sent = 0;
+    uint16_t number = 0;        // Registers requested
+    int64_t last_byte = 0;      // Last bus activity, us
+    int64_t deadline = 0;
+    RtuRing ring;
+
+    // Fail the transaction with an error code.
+    RtuState fail(int code);
+    // Parse the response in the ring, if complete.
+    RtuState parse();
+
+  public:
+    RtuMaster(uint32_t timeout_ms = 500, uint32_t byte_timeout_ms = 500)
+        : timeout_us(timeout_ms * 1000),
+          byte_timeout_us(byte_timeout_ms * 1000) {}
+    // Use a serial descriptor opened at baud for slave addr.
+    void attach(int fd, uint32_t baud, uint8_t addr);
+    // Change serial baud rate.
+    void setBaud(uint32_t baud);
+    // Change slave's address
+    void setAddr(uint8_t new_addr) { addr = new_addr; }
+    // Change longest gap allowed between bytes of a response
+    void setByteTimeout(uint32_t ms) { byte_timeout_us = ms * 1000; }
+
+    // Start reading number holding registers from reg.
+    // Return 0 on success, -1 if detached or busy.
+    int requestRead(uint16_t reg, uint16_t number);
+    // Advance the transaction without blocking, return its state.
+    RtuState poll();
+    // Return microseconds until poll() may make progress, -1 if idle.
+    int64_t getWait();
+    // Copy registers of a done transaction, return count, -1 if not done.
+    int getRegisters(uint16_t *dest);
+    // Read registers, blocking until done. Return count, -1 on failure.
+    int readRegisters(uint16_t reg, uint16_t number, uint16_t *dest);
+
+    // Return transaction state
+    RtuState getState()         { return state; }
+    // Return last error: Modbus exception code, or negative errno-like code
+    int getError()              { return error; }
+    // Return inter-frame silence in us
+    uint32_t getSilence()       { return silence_us; }
+};
+#endif
@@ -0,0 +1,58 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+#include <cstdint>
+#include <vector>
+
+/* Adaptive per-channel oversampling within a fixed bus budget.
+   Each channel's read noise and rate of change are estimated online.
+   Noisy or changing channels get more reads per cycle so their average
+   reaches `target` volts of standard error; stable ones back off to the
+   minimum. Reads are issued in passes over the span of channels still
+   due, and the bus time of all passes never exceeds the budget. Bus time
+   is counted in character times: the frames, plus the silences and the
+   slave turnaround of each transaction.
+*/
+class Sampler {
+  private:
+    int channels;
+    int full_reads;
+    int overhead;               // Characters lost per transaction
+    int budget;                 // Bus characters per cycle
+    int min_reads;
+    int max_reads;
+    float target;               // Target standard error in volts
+    float period = 1;           // Last cycle length, s
+    std::vector<float> noise;   // Read variance, V^2
+    std::vector<float> rate;    // Rate of change, V/s
+    std::vector<float> tau;     // Rate estimator time constant, s
+    std::vector<float> last;    // Previous cycle average
+    std::vector<int> reads;     // Planned reads this cycle
+    std::vector<double> sum;
+    std::vector<double> sum_sq;
+    std::vector<int> count;
+
+    // Return bus characters of one pass over number channels.
+    int passCost(int number);
+    // Return bus characters needed by the current plan.
+    int cost();
+
+  public:
+    // Budget is given as reads of all channels per cycle.
+    Sampler(int channels, int full_reads, int max_reads, float target);
+    // Set serial baud rate, which sets the per-transaction overhead.
+    void setBaud(uint32_t baud);
+    // Set a channel's sensor response time, lower bound of rate smoothing.
+    void setResponseTime(int ch, float seconds);
+    // Plan reads of the next cycle, return number of passes.
+    int plan();
+    // Return channel span read in a pass, false if none.
+    bool getSpan(int pass, int &first, int &number);
+    // Add values read in a pass, starting at channel first.
+    void add(int pass, int first, int number, const float *voltage);
+    // Close a cycle lasting dt seconds and write channel averages.
+    void finish(float dt, float *average);
+
+    // Return planned reads of a channel
+    int getReads(int ch)    { return reads[ch]; }
+};
+#endif
@@ -0,0 +1,203 @@
+#ifndef SHMFEED_H
+#define SHMFEED_H
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Shared-memory feed of acquisition frames for local consumers.
+   One producer writes a ring of `capacity` slots; any number of readers
+   map it read-only and follow it at their own pace without syscalls.
+   Each slot is guarded by a sequence lock: odd while being written.
+   Readers that fall more than `capacity` frames behind skip ahead and
+   count the frames they lost. `generation` is odd while the writer
+   (re)creates the ring; readers of an earlier run then continue from the
+   new newest frame.
+
+   Reader usage, this header only:
+       ShmFeedReader feed;
+       ShmFrame frame;
+       if (feed.attach() == 0) {
+           while (true) {
+               if (feed.read(frame) > 0) { ... }
+           }
+       }
+*/
+
+#define SHMFEED_NAME "/aquasense-feed"
+#define SHMFEED_MAGIC 0x53465141     // "AQFS"
+#define SHMFEED_VERSION 2
+#define SHMFEED_CH_MAX 8
+
+struct ShmFrame {
+    uint64_t seq;                   // Frame number, starts at 1
+    int64_t timestamp;              // CLOCK_REALTIME in ns
+    uint32_t channels;              // Valid entries in voltage
+    float voltage[SHMFEED_CH_MAX];  // Averaged channel voltages
+};
+
+struct alignas(64) ShmSlot {
+    std::atomic<uint32_t> lock;
+    ShmFrame frame;
+};
+
+struct alignas(64) ShmHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_size;
+    std::atomic<uint32_t> head;     // Slot of the newest frame
+    std::atomic<uint32_t> generation; // Odd while the ring is rebuilt
+};
+
+class ShmFeedReader {
+  private:
+    void *map = MAP_FAILED;
+    size_t map_size = 0;
+    const ShmHeader *header = nullptr;
+    const ShmSlot *slots = nullptr;
+    uint32_t capacity = 0;
+    uint32_t generation = 0;
+    uint64_t next = 0;
+    uint64_t lost = 0;
+
+    // Copy slot's frame, return false if it changed meanwhile.
+    bool load(const ShmSlot &slot, ShmFrame &frame) {
+        uint32_t before = slot.lock.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        memcpy(&frame, &slot.frame, sizeof(frame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.lock.load(std::memory_order_relaxed) == before;
+    }
+
+    // Follow a restarted writer. Return 1 while it rebuilds the ring,
+    // -1 if the ring no longer fits the mapping and the reader has to
+    // attach again.
+    int resync() {
+        uint32_t current = header->generation.load(std::memory_order_acquire);
+        if (current == generation) {
+            return 0;
+        }
+        if (current & 1) {
+            return 1;
+        }
+        if (header->capacity != capacity
+            || header->slot_size != sizeof(ShmSlot)) {
+            detach();
+            return -1;
+        }
+        generation = current;
+        seekLatest();
+        return 0;
+    }
+
+  public:
+    ~ShmFeedReader() { detach(); }
+
+    // Map the feed and start at its newest frame. Return 0 on success.
+    int attach(const char *name = SHMFEED_NAME) {
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(ShmHeader)) {
+            close(fd);
+            return -1;
+        }
+        map_size = st.st_size;
+        map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            return -1;
+        }
+
+        header = (const ShmHeader *) map;
+        generation = header->generation.load(std::memory_order_acquire);
+        if (header->magic != SHMFEED_MAGIC
+            || (generation & 1)
+            || header->version != SHMFEED_VERSION
+            || header->slot_size != sizeof(ShmSlot)
+            || sizeof(ShmHeader) + header->capacity * sizeof(ShmSlot) > map_size) {
+            detach();
+            return -1;
+        }
+        slots = (const ShmSlot *) (header + 1);
+        capacity = header->capacity;
+        seekLatest();
+        return 0;
+    }
+
+    void detach() {
+        if (map != MAP_FAILED) {
+            munmap(map, map_size);
+        }
+        map = MAP_FAILED;
+        header = nullptr;
+        slots = nullptr;
+    }
+
+    // Continue from the newest frame.
+    void seekLatest() {
+        ShmFrame frame;
+        uint32_t head = header->head.load(std::memory_order_acquire);
+        while (load(slots[head], frame) == false) {}
+        next = frame.seq + 1;
+    }
+
+    // Copy next frame. Return 1 if read, 0 if none yet, -1 if not
+    // attached or the writer restarted with a different ring size.
+    int read(ShmFrame &frame) {
+        if (slots == nullptr) {
+            return -1;
+        }
+        while (true) {
+            int status = resync();
+            if (status != 0) {
+                return status < 0 ? -1 : 0;
+            }
+            const ShmSlot &slot = slots[next % capacity];
+            if (load(slot, frame) == false
+                || header->generation.load(std::memory_order_relaxed) != generation) {
+                continue;
+            }
+            if (frame.seq < next) {
+                return 0;
+            }
+            if (frame.seq > next) {
+                // Overwritten: resume at the oldest frame still in the ring.
+                uint64_t oldest = frame.seq - capacity + 1;
+                lost += oldest - next;
+                next = oldest;
+                continue;
+            }
+            next++;
+            return 1;
+        }
+    }
+
+    // Return number of frames skipped because the reader fell behind
+    uint64_t getLost() { return lost; }
+};
+
+class ShmFeedWriter {
+  private:
+    void *map = MAP_FAILED;
+    size_t map_size = 0;
+    ShmHeader *header = nullptr;
+    ShmSlot *slots = nullptr;
+    uint64_t seq = 0;
+
+  public:
+    ~ShmFeedWriter();
+    // Create the feed with room for `capacity` frames. Return 0 on success.
+    int open(uint32_t capacity, const char *name = SHMFEED_NAME);
+    // Publish one frame of `channels` voltages.
+    void publish(const float *voltage, uint32_t channels);
+};
+#endif
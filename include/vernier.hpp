@@ -1,7 +1,6 @@
 #ifndef VernierLib_h
 #define VernierLib_h
 #include <cmath>
-#endif
 #define VERNLIB32_VERSION "1.0.0"
 
 /* Custom library based on Vernier's VernierLib.
@@ -23,9 +22,9 @@ class Vernier {
     // Return sensor's respone time in seconds.
     int getResponseTime()    { return response_time; }
     // Calculate the sensor value from measured voltage.
-    float readSensor(float voltage);
+    virtual float readSensor(float voltage);
     // Calculate the sensor value from ADC count.
-    float readSensor(int rawADC);
+    virtual float readSensor(int rawADC);
 
     void setVin(float voltage) { Vin = voltage; }
     void calibrate(float slope, float intercept);
@@ -77,4 +76,5 @@ class FPHSensor : public Vernier {
     FPHSensor();
 };
 
-// END OF FILE
\ No newline at end of file
+#endif
+// END OF FILE
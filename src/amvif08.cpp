@@ -1,8 +1,7 @@
 #include "amvif08.hpp"
+#include "baudrate.hpp"
 #include <arpa/inet.h>
 #include <fcntl.h>
-#include <map>
-#include <stdexcept>
 
 #define PARITY_N 'N'
 #define PARITY_O 'O'
@@ -10,6 +9,7 @@
 #define BROADCAST 0xFF
 #define ADDR_MAX 247
 #define CH_MAX 8
+#define BAUD_CODE_MAX 7
 
 #ifdef DEBUG
 #include <cerrno>
@@ -42,17 +42,6 @@ struct Defaults {
     static const char  parity               = PARITY_N;
 };
 
-std::map<short, uint16_t> baudrates {
-    {1200, 0},
-    {2400, 1},
-    {4800, 2},
-    {9600, 3},
-    {19200, 4},
-    {38400, 5},
-    {57600, 6},
-    {115200, 7}
-};
-
 bool AMVIF08::isValidChannel(unsigned short ch) {
     return (ch > 0 && ch <= CH_MAX);
 }
@@ -84,51 +73,79 @@ int AMVIF08::connect(const char *port) {
     baudrate = Defaults::baudrate;
     parity = Defaults::parity;
     return_time = Defaults::return_time;
+    rtu.attach(modbus_get_socket(ctx), baudrate, 1);
     return modbus_get_socket(ctx);
 }
 
-std::vector<float>  AMVIF08::readVoltage(uint16_t ch, uint8_t number) {
-    std::vector<float> voltage;
-    uint16_t read_data[number];
-
+int AMVIF08::readVoltageRaw(uint16_t ch, uint8_t number, uint16_t *raw) {
     if (isValidChannel(ch) == false) {
         DEBUG_PRINT("Invalid channel: " << ch);
+        return -1;
     }
-    else if (isValidChannel(ch + number -1) == false) {
+    if (isValidChannel(ch + number -1) == false) {
         DEBUG_PRINT("Invalid read number: " << number);
+        return -1;
     }
     // Channel 1-7 indicated at 0x00A0-0x00A7.
-    else if (modbus_read_registers(ctx, ch-1+0xA0, number, read_data) < 0) {
+    int rc = fast_read ? rtu.readRegisters(ch-1+0xA0, number, raw)
+                       : modbus_read_registers(ctx, ch-1+0xA0, number, raw);
+    if (rc < 0) {
         DEBUG_PRINT("Cannot read voltage values.");
+        return -1;
     }
-    else {
-        for (int i = 0; i < number; i++) {
-            voltage.push_back((float) read_data[i] / 100.0);
-        }
+    return number;
+}
+
+int AMVIF08::readVoltage(uint16_t ch, uint8_t number, float *voltage) {
+    uint16_t read_data[CH_MAX];
+
+    if (readVoltageRaw(ch, number, read_data) < 0) {
+        return -1;
     }
-    return voltage;
+    for (int i = 0; i < number; i++) {
+        voltage[i] = (float) read_data[i] / 100.0;
+    }
+    return number;
 }
 
-std::vector<float> AMVIF08::getVoltageRatio(uint16_t ch, uint8_t number) {
-    std::vector<float> ratio;
-    uint16_t read_data[number];
+int AMVIF08::getVoltageRatio(uint16_t ch, uint8_t number, float *ratio) {
+    uint16_t read_data[CH_MAX];
 
     if (isValidChannel(ch) == false) {
         DEBUG_PRINT("Invalid channel: " << ch);
+        return -1;
     }
-    else if (isValidChannel(ch + number -1) == false) {
+    if (isValidChannel(ch + number -1) == false) {
         DEBUG_PRINT("Invalid read number: " << number);
+        return -1;
     }
     // Channel 1-7 indicated at 0x00C0-0x00C7.
-    else if (modbus_read_registers(ctx, ch-1+0xC0, number, read_data) < 0) {
+    if (modbus_read_registers(ctx, ch-1+0xC0, number, read_data) < 0) {
         DEBUG_PRINT("Cannot read voltage ratios.");
+        return -1;
     }
-    else {
-        for (int i = 0; i < number; i++) {
-            ratio.push_back((float) read_data[i] / 1000.0);
-        }
+    for (int i = 0; i < number; i++) {
+        ratio[i] = (float) read_data[i] / 1000.0;
     }
-    return ratio;
+    return number;
+}
+
+std::vector<float> AMVIF08::readVoltage(uint16_t ch, uint8_t number) {
+    float voltage[CH_MAX];
+    int n = readVoltage(ch, number, voltage);
+    if (n < 0) {
+        return {};
+    }
+    return std::vector<float>(voltage, voltage + n);
+}
+
+std::vector<float> AMVIF08::getVoltageRatio(uint16_t ch, uint8_t number) {
+    float ratio[CH_MAX];
+    int n = getVoltageRatio(ch, number, ratio);
+    if (n < 0) {
+        return {};
+    }
+    return std::vector<float>(ratio, ratio + n);
 }
 
 short AMVIF08::factoryReset() {
@@ -139,6 +156,7 @@ short AMVIF08::factoryReset() {
     }
 
     modbus_set_slave(ctx, 1);
+    rtu.setAddr(1);
     return_time = Defaults::return_time;
     baudrate    = Defaults::baudrate;
     parity      = Defaults::parity;
@@ -171,6 +189,7 @@ short AMVIF08::setAddr(unsigned short newaddr) {
     }
     
     modbus_set_slave(ctx, newaddr);
+    rtu.setAddr(newaddr);
     return 0;
 }
 
@@ -192,12 +211,9 @@ short AMVIF08::setVoltageRatio(unsigned short ch, float ratio) {
     return 0;
 }
 
-short AMVIF08::setBaudRate(unsigned short target_baud) {
-    uint16_t baud_code;
-    try {
-        baud_code = baudrates.at(target_baud);
-    }
-    catch (const std::out_of_range &e) {
+short AMVIF08::setBaudRate(uint32_t target_baud) {
+    int baud_code = baudCode(target_baud, BAUD_CODE_MAX);
+    if (baud_code < 0) {
         DEBUG_PRINT("Not supported baudrate.");
         return -1;
     }
@@ -234,6 +250,14 @@ short AMVIF08::setParity(char type) {
 }
 
 void AMVIF08::updateContext() {
+    int addr = modbus_get_slave(ctx);
+    modbus_close(ctx);
     modbus_free(ctx);
     ctx = modbus_new_rtu(rs485_port.c_str(), baudrate, parity, 8, 1);
+    modbus_set_slave(ctx, addr);
+    if (modbus_connect(ctx) < 0) {
+        DEBUG_PRINT("Cannot reconnect to device: "
+                    << modbus_strerror(errno));
+    }
+    rtu.attach(modbus_get_socket(ctx), baudrate, addr);
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "burst.hpp"
+#include <algorithm>
+#include <chrono>
+
+#define HEADER_SIZE 17
+#define VARINT32_MAX 5
+#define VARINT17_MAX 3
+#define RETRY_MAX 3     // Consecutive failed reads before giving up
+
+#ifdef DEBUG
+#include <iostream>
+
+#define DEBUG_PRINT(MSG)               \
+{                                      \
+    std::cerr << __func__ << ", line " \
+              << __LINE__ << ":\t"     \
+              << MSG << "\n";          \
+}
+#else
+#define DEBUG_PRINT(MSG)
+#endif
+
+using namespace std::chrono;
+
+static uint8_t *putVarint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    *p++ = v;
+    return p;
+}
+
+Burst::Burst(int channels, size_t max_frames, unsigned max_window)
+    : channels(channels), max_frames(max_frames), max_window(max_window),
+      samples(max_frames * channels), stamps(max_frames),
+      block(HEADER_SIZE + max_frames * (VARINT32_MAX
+                                        + channels * VARINT17_MAX)) {}
+
+int Burst::trigger(unsigned new_mask, unsigned window_ms) {
+    if (new_mask == 0 || (new_mask >> channels) != 0) {
+        DEBUG_PRINT("Invalid channel mask: " << new_mask);
+        return -1;
+    }
+    if (window_ms == 0 || window_ms > max_window) {
+        DEBUG_PRINT("Invalid window: " << window_ms << " ms");
+        return -1;
+    }
+    request_mutex.lock();
+    request_mask |= new_mask;
+    request_window = std::max(request_window, window_ms);
+    request_mutex.unlock();
+    return 0;
+}
+
+bool Burst::pending() {
+    request_mutex.lock();
+    bool requested = request_mask != 0;
+    request_mutex.unlock();
+    return requested;
+}
+
+void Burst::cancel() {
+    request_mutex.lock();
+    request_mask = request_window = 0;
+    request_mutex.unlock();
+}
+
+int Burst::capture(AMVIF08 &adc) {
+    request_mutex.lock();
+    mask = request_mask;
+    unsigned window = request_window;
+    request_mask = request_window = 0;
+    request_mutex.unlock();
+
+    frames = 0;
+    block_size = 0;
+    if (mask == 0) {
+        return 0;
+    }
+
+    // One request over the span of selected channels costs less bus time
+    // than one request per channel, unselected ones are discarded.
+    int first = __builtin_ctz(mask);
+    int last = 31 - __builtin_clz(mask);
+    int span = last - first + 1;
+    uint16_t read_data[32];
+
+    start_ms = duration_cast<milliseconds>(
+        system_clock::now().time_since_epoch()).count();
+    auto start = steady_clock::now();
+    auto end = start + milliseconds(window);
+    int failures = 0;
+
+    while (frames < max_frames) {
+        auto now = steady_clock::now();
+        if (now >= end) {
+            break;
+        }
+        if (adc.readVoltageRaw(first + 1, span, read_data) < 0) {
+            if (++failures >= RETRY_MAX) {
+                break;
+            }
+            continue;
+        }
+        failures = 0;
+
+        stamps[frames] = duration_cast<microseconds>(now - start).count();
+        uint16_t *frame = &samples[frames * channels];
+        int n = 0;
+        for (int ch = first; ch <= last; ch++) {
+            if (mask & (1u << ch)) {
+                frame[n++] = read_data[ch - first];
+            }
+        }
+        frames++;
+    }
+    return frames;
+}
+
+size_t Burst::encode() {
+    uint8_t *p = block.data();
+    *p++ = BURST_MAGIC[0];
+    *p++ = BURST_MAGIC[1];
+    *p++ = BURST_VERSION;
+    *p++ = mask;
+    p = putVarint(p, frames);
+    for (int i = 0; i < 8; i++) {
+        *p++ = (start_ms >> (8 * i)) & 0xFF;
+    }
+
+    uint32_t prev_stamp = 0;
+    for (size_t i = 0; i < frames; i++) {
+        p = putVarint(p, stamps[i] - prev_stamp);
+        prev_stamp = stamps[i];
+    }
+
+    // Channel-major deltas keep slowly moving signals at one byte each.
+    int selected = __builtin_popcount(mask);
+    for (int c = 0; c < selected; c++) {
+        int32_t prev = 0;
+        for (size_t i = 0; i < frames; i++) {
+            int32_t v = samples[i * channels + c];
+            int32_t delta = v - prev;
+            prev = v;
+            p = putVarint(p, (uint32_t) ((delta << 1) ^ (delta >> 31)));
+        }
+    }
+
+    block_size = p - block.data();
+    return block_size;
+}
@@ -0,0 +1,61 @@
+#include "detector.hpp"
+#include <algorithm>
+
+// Samples needed before CUSUM alarms are trusted.
+#define WARMUP 10
+
+Detector::Detector(float rate_limit, float min_std, float drift,
+                   float threshold, unsigned window, float horizon)
+    : rate_limit(rate_limit), drift(drift), threshold(threshold),
+      min_std(min_std), window(std::max(window, 2u)),
+      horizon(std::max(horizon, 0.001f)) {}
+
+void Detector::reset() {
+    n = 0;
+    mean = var = 0;
+    last = NAN;
+    rate = 0;
+    cusum_pos = cusum_neg = 0;
+}
+
+int Detector::update(float value, float dt) {
+    if (std::isnan(value)) {
+        return EVENT_NONE;
+    }
+
+    int events = EVENT_NONE;
+    if (std::isnan(last) == false && dt > 0) {
+        // Exponential average of the slope, weighted by elapsed time.
+        float alpha = 1 - std::exp(-dt / horizon);
+        rate += alpha * ((value - last) / dt - rate);
+        if (std::fabs(rate) > rate_limit) {
+            events |= EVENT_RATE;
+        }
+    }
+    last = value;
+
+    // Score the sample against the statistics before it is folded in.
+    if (n >= WARMUP) {
+        float std_dev = std::max((float) std::sqrt(var), min_std);
+        float z = (value - mean) / std_dev;
+        cusum_pos = std::max(0.0f, cusum_pos + z - drift);
+        cusum_neg = std::max(0.0f, cusum_neg - z - drift);
+        if (cusum_pos > threshold) {
+            events |= EVENT_RISE;
+            cusum_pos = 0;
+        }
+        if (cusum_neg > threshold) {
+            events |= EVENT_DROP;
+            cusum_neg = 0;
+        }
+    }
+
+    // Welford update; capping n turns it into exponential forgetting.
+    if (n < window) {
+        n++;
+    }
+    double delta = value - mean;
+    mean += delta / n;
+    var += (delta * (value - mean) - var) / n;
+    return events;
+}
@@ -0,0 +1,167 @@
+#include "heapguard.hpp"
+#ifdef STATIC_MEM
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+static std::atomic<bool> sealed(false);
+static std::atomic<unsigned long> alloc_count(0);
+static std::atomic<long> live_bytes(0);
+static long sealed_bytes = 0;
+static long reported = 0;
+
+// glibc's own allocator entry points, which the replacements forward to.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t number, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+void __libc_free(void *p);
+}
+
+// Account for block p coming into use.
+static void *track(void *p) {
+    if (p != NULL) {
+        live_bytes.fetch_add(malloc_usable_size(p), std::memory_order_relaxed);
+        if (sealed.load(std::memory_order_relaxed)) {
+            alloc_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return p;
+}
+
+// Account for block p going out of use.
+static void untrack(void *p) {
+    if (p != NULL) {
+        live_bytes.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+    }
+}
+
+static bool isPowerOfTwo(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+/* Defining the C allocator in the executable interposes it for every
+   shared library too, so libmosquitto and libmodbus are counted as well
+   as operator new, which libstdc++ builds on malloc.
+*/
+extern "C" void *malloc(size_t size) {
+    return track(__libc_malloc(size));
+}
+
+extern "C" void *calloc(size_t number, size_t size) {
+    return track(__libc_calloc(number, size));
+}
+
+extern "C" void *realloc(void *p, size_t size) {
+    // The old block may move or be freed, so account it as released.
+    size_t old_size = p != NULL ? malloc_usable_size(p) : 0;
+    void *q = __libc_realloc(p, size);
+    if (q == NULL && size != 0) {
+        return NULL;            // Old block is untouched
+    }
+    live_bytes.fetch_sub(old_size, std::memory_order_relaxed);
+    return track(q);
+}
+
+extern "C" void *reallocarray(void *p, size_t number, size_t size) {
+    if (size != 0 && number > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(p, number * size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size) {
+    return track(__libc_memalign(alignment, size));
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+    if (isPowerOfTwo(alignment) == false) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **p, size_t alignment, size_t size) {
+    if (isPowerOfTwo(alignment) == false || alignment % sizeof(void *) != 0) {
+        return EINVAL;
+    }
+    void *q = memalign(alignment, size);
+    if (q == NULL) {
+        return ENOMEM;
+    }
+    *p = q;
+    return 0;
+}
+
+extern "C" void *valloc(size_t size) {
+    return track(__libc_valloc(size));
+}
+
+extern "C" void *pvalloc(size_t size) {
+    return track(__libc_pvalloc(size));
+}
+
+extern "C" void free(void *p) {
+    untrack(p);
+    __libc_free(p);
+}
+
+void heapguard::seal() {
+    sealed_bytes = live_bytes.load();
+    sealed.store(true);
+}
+
+unsigned long heapguard::getCount() {
+    return alloc_count.load(std::memory_order_relaxed);
+}
+
+long heapguard::getLive() {
+    return live_bytes.load(std::memory_order_relaxed);
+}
+
+long heapguard::getGrowth() {
+    if (sealed.load() == false) {
+        return 0;
+    }
+    return getLive() - sealed_bytes;
+}
+
+long heapguard::getRSS() {
+    // Read through a raw descriptor, stdio would allocate its buffer.
+    char buf[64];
+    int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    long size, resident;
+    if (sscanf(buf, "%ld %ld", &size, &resident) != 2) {
+        return -1;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long heapguard::checkGrowth() {
+    long growth = getGrowth();
+    if (growth <= reported) {
+        return 0;
+    }
+    reported = growth;
+    return growth;
+}
+#endif
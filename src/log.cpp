@@ -0,0 +1,76 @@
+#include "log.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+
+using namespace std::chrono;
+
+Log::Log(size_t capacity, int rate)
+    : lines(capacity), dropped(0), rate(std::max(rate, 1)),
+      tokens(rate), last(steady_clock::now()) {
+    sem_init(&ready, 0, 0);
+}
+
+Log::~Log() {
+    sem_destroy(&ready);
+}
+
+void Log::wait() {
+    while (sem_wait(&ready) < 0 && errno == EINTR) {}
+}
+
+void Log::queue(bool error, const char *format, va_list args) {
+    LogLine line;
+    line.error = error;
+    vsnprintf(line.text, sizeof(line.text), format, args);
+    if (lines.push(line) == false) {
+        dropped++;
+    }
+    // One pending wakeup is enough, the writer flushes everything.
+    int value;
+    if (sem_getvalue(&ready, &value) == 0 && value > 0) {
+        return;
+    }
+    sem_post(&ready);
+}
+
+void Log::print(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    queue(false, format, args);
+    va_end(args);
+}
+
+void Log::error(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    queue(true, format, args);
+    va_end(args);
+}
+
+int Log::flush() {
+    auto now = steady_clock::now();
+    tokens = std::min<double>(rate, tokens + rate
+                              * duration<double>(now - last).count());
+    last = now;
+
+    int written = 0;
+    LogLine line;
+    while (tokens >= 1 && lines.pop(line)) {
+        FILE *out = line.error ? stderr : stdout;
+        fputs(line.text, out);
+        fputc('\n', out);
+        tokens--;
+        written++;
+    }
+    unsigned long lost = dropped.load();
+    if (lost != reported) {
+        fprintf(stderr, "(%lu log lines dropped)\n", lost - reported);
+        reported = lost;
+    }
+    if (written > 0) {
+        fflush(stdout);
+    }
+    return written;
+}
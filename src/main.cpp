@@ -1,14 +1,26 @@
 #include "amvif08.hpp"
+#include "burst.hpp"
+#include "detector.hpp"
+#include "heapguard.hpp"
+#include "log.hpp"
+#include "power.hpp"
+#include "publisher.hpp"
+#include "sampler.hpp"
+#include "shmfeed.hpp"
 #include "vernier.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <cmath>
-#include <functional>
-#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 #include <mutex>
-#include <string>
 #include <thread>
+#include <unistd.h>
 #include <vector>
 #include <mosquittopp.h>
 
@@ -17,6 +29,7 @@
 #define ODO_CH 2
 #define FPH_CH 3
 #define BOARD "matrix752"
+#define MSG_MAX 128             // Encoded message capacity
 
 #ifndef PORT
 #define PORT "/dev/ttymxc1"
@@ -30,127 +43,570 @@
 using namespace std::chrono;
 
 const int read_num = 4;         // Number of voltage inputs
-const int sample_rate = 10;     // 10 samples per read
+const int sample_rate = 10;     // Bus budget: 10 reads of all channels
+const int sample_max = 20;      // Most reads of one channel per cycle
+const float sample_error = 0.005; // Target standard error in volts
 
 const char *tmp_topic = BOARD "/vernier/tmp-bta";
 const char *odo_topic = BOARD "/vernier/odo-bta";
 const char *fph_topic = BOARD "/vernier/fph-bta";
+const char *event_topic = BOARD "/vernier/events";
+const int event_qos = 2;        // Events are delivered exactly once
 
-std::vector<float> voltage_avg(read_num);
+// Detector limits: rate of change per second and noise floor.
+const float tmp_rate_limit = 0.5, tmp_min_std = 0.05;   // Deg C
+const float odo_rate_limit = 0.5, odo_min_std = 0.05;   // mg/L
+const float fph_rate_limit = 0.2, fph_min_std = 0.02;   // pH
+
+// Sampling period in normal mode, and faster sampling of a channel after
+// one of its events.
+const auto normal_period = 1s;
+const auto boost_period = 200ms;
+const auto boost_hold = 30s;
+std::atomic<steady_clock::rep> boost_until[read_num];
+
+// Burst capture: requested on burst_cmd_topic with "<channel mask> [ms]",
+// e.g. "0x08 2000" for CH4, or by a detector event.
+const char *burst_cmd_topic = BOARD "/cmd/burst";
+const char *burst_topic = BOARD "/vernier/burst";
+const unsigned burst_window = 2000;     // Default window in ms
+const unsigned burst_window_max = 10000; // Longest acquisition pause in ms
+const size_t burst_frames = 4096;       // Capture buffer capacity
+
+// Local consumers attach to SHMFEED_NAME, see shmfeed.hpp.
+const uint32_t feed_frames = 256;       // Shared-memory ring capacity
+
+// Power report, and low-power mode (-l <period>) MQTT handling.
+const char *power_topic = BOARD "/status/power";
+const auto power_report = 60s;
+const auto mqtt_window = 500ms;         // Longest MQTT exchange per window
+const int mqtt_poll = 20;               // MQTT socket wait, in ms
+const long low_power_max = 65535 / 2;   // Keeps 2 * period a valid keepalive
+const auto reconnect_min = 10s;         // Back-off after a failed attempt,
+const auto reconnect_max = 15min;       // doubled up to this
+
+// Low-power reconnect state, only used by its single thread.
+bool connecting = false;                // Connect started, no CONNACK yet
+steady_clock::duration reconnect_backoff = reconnect_min;
+steady_clock::time_point reconnect_at;  // Earliest next attempt
+
+// Publish stage: lane slots, coalesced topics and QoS 1/2 messages in
+// flight. Routine readings coalesce per topic while the uplink is backed
+// up, events drop their oldest only when their own lane overflows.
+const size_t event_slots = 32;
+const size_t routine_slots = 64;
+const size_t publish_topics = 8;
+const size_t publish_window = 8;
+const size_t log_slots = 64;
+const int log_rate = 10;                // Console lines per second
+
+// Acquisition buffers, sized once in main() before the heap is sealed.
+std::vector<float> voltage_avg;
+std::vector<float> voltage_read;
 std::mutex voltage_avg_mutex;
+
+// Stamp of the acquisition held in voltage_avg.
+struct Frame {
+    unsigned long seq = 0;              // 0 before the first acquisition
+    steady_clock::time_point time;
+};
+Frame voltage_frame;
 float tmp = NAN, odo = NAN, fph = NAN;
 AMVIF08 ADC;
-mosqpp::mosquittopp matrix752;
+Burst burst(read_num, burst_frames, burst_window_max);
+Sampler sampler(read_num, sample_rate, sample_max, sample_error);
+ShmFeedWriter feed;
+PowerStats power;
+Publisher publisher(event_slots, routine_slots, publish_topics,
+                    publish_window, Overflow::drop_oldest, Overflow::coalesce);
+Log console(log_slots, log_rate);
+
+class Client : public mosqpp::mosquittopp {
+  public:
+    void on_connect(int rc);
+    void on_disconnect(int rc);
+    void on_publish(int mid);
+    void on_message(const struct mosquitto_message *message);
+};
+
+Client matrix752;
+
+void Client::on_connect(int rc) {
+    if (rc == 0) {
+        subscribe(NULL, burst_cmd_topic, 1);
+        publisher.setConnected(true);
+    }
+}
+
+void Client::on_disconnect(int) {
+    publisher.setConnected(false);
+}
+
+void Client::on_publish(int mid) {
+    publisher.acknowledge(mid);
+}
 
-void publishSensorData(const char* topic, std::string name, float value) {
+void Client::on_message(const struct mosquitto_message *message) {
+    if (strcmp(message->topic, burst_cmd_topic) != 0) {
+        return;
+    }
+    char cmd[32];
+    int len = std::min(message->payloadlen, (int) sizeof(cmd) - 1);
+    memcpy(cmd, message->payload, len);
+    cmd[len] = '\0';
+
+    int mask = 0;
+    unsigned window = burst_window;
+    if (sscanf(cmd, "%i %u", &mask, &window) < 1) {
+        console.error("Invalid burst command: %s", cmd);
+        return;
+    }
+    if (burst.trigger(mask, window) < 0) {
+        console.error("Burst command out of range: %s "
+                      "(channel mask 0x1-0x%x, window 1-%u ms)",
+                      cmd, (1u << read_num) - 1, burst.getMaxWindow());
+    }
+}
+
+// Hand a message to the publish stage and log it.
+void queueMessage(Lane lane, const char *topic, const char *msg, int len,
+                  int qos) {
+    if (publisher.push(lane, topic, msg, len, qos) < 0) {
+        console.error("Publish queue full, dropped: %s", msg);
+    }
+    else console.print("%s", msg);
+}
+
+void publishSensorData(const char* topic, const char *name, float value) {
     if (std::isnan(value)) {
         value = 0.0;
     }
 
-    std::string msg = "{";
-    msg += "\"name\":\"" + name + "\",";
-    msg += "\"value\":" + std::to_string(value);
-    msg += "}";
-
-    int rc = matrix752.publish(NULL, topic, msg.size(), msg.c_str(), 1);
-    if (rc == MOSQ_ERR_SUCCESS){
-        std::cout << msg << std::endl;
+    char msg[MSG_MAX];
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"name\":\"%s\",\"value\":%f}", name, value);
+    if (len < 0 || len >= (int) sizeof(msg)) {
+        console.error("Message too long for %s", topic);
+        return;
     }
-    else std::cerr << "Publish failed. ERR: " << rc << std::endl;
+    queueMessage(Lane::routine, topic, msg, len, 1);
 }
 
-float getVout(int ch) {
+// Return channel's averaged voltage and the stamp of its acquisition.
+float getVout(int ch, Frame &frame) {
     voltage_avg_mutex.lock();
     float vout = voltage_avg[ch];
+    frame = voltage_frame;
     voltage_avg_mutex.unlock();
     return vout;
 }
 
-void readTemp() {
-    SSTempSensor TMP;
-    int response_time = TMP.getResponseTime();
-    std::this_thread::sleep_for(seconds(response_time));
+// Publish a detector event on the event topic.
+void publishEvent(const char *name, int events, float value,
+                  Detector &detector) {
+    char list[32] = "";
+    if (events & EVENT_RATE) strcat(list, "\"rate\",");
+    if (events & EVENT_RISE) strcat(list, "\"rise\",");
+    if (events & EVENT_DROP) strcat(list, "\"drop\",");
+    list[strlen(list) - 1] = '\0'; // Trailing comma
 
-    while (true) {
-        float vout = getVout(TMP_CH);
-        if (vout > 0.0) {
-            tmp = TMP.readSensor(vout);
+    char msg[MSG_MAX];
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"name\":\"%s\",\"events\":[%s],"
+                       "\"value\":%f,\"mean\":%f,\"rate\":%f}",
+                       name, list, value,
+                       detector.getMean(), detector.getRate());
+    if (len < 0 || len >= (int) sizeof(msg)) {
+        console.error("Message too long for %s", event_topic);
+        return;
+    }
+    queueMessage(Lane::event, event_topic, msg, len, event_qos);
+}
+
+// Sample the channel faster until boost_hold has passed.
+void boostChannel(int ch) {
+    auto until = steady_clock::now() + boost_hold;
+    boost_until[ch].store(until.time_since_epoch().count());
+}
+
+// Return true while the channel samples faster after an event.
+bool isBoosted(int ch) {
+    auto now = steady_clock::now().time_since_epoch().count();
+    return now < boost_until[ch].load();
+}
+
+// Return current sampling period of a channel: base unless boosted.
+steady_clock::duration channelPeriod(int ch, steady_clock::duration base) {
+    if (isBoosted(ch)) {
+        return std::min<steady_clock::duration>(base, boost_period);
+    }
+    return base;
+}
+
+// Return shortest sampling period over all channels.
+steady_clock::duration acquisitionPeriod(steady_clock::duration base) {
+    steady_clock::duration period = base;
+    for (int ch = 0; ch < read_num; ch++) {
+        period = std::min(period, channelPeriod(ch, base));
+    }
+    return period;
+}
+
+// Convert, check and publish a sensor channel if it was acquired after
+// the last frame it saw.
+void checkSensor(Vernier &sensor, int ch, const char *topic,
+                 const char *name, Detector &detector, float &value,
+                 Frame &last) {
+    Frame frame;
+    float vout = getVout(ch, frame);
+    if (frame.seq == last.seq) {
+        return;
+    }
+    float dt = 0;
+    if (last.seq != 0) {
+        dt = duration<float>(frame.time - last.time).count();
+    }
+    last = frame;
+
+    if (vout > 0.0) {
+        value = sensor.readSensor(vout);
+    }
+    else value = NAN;
+
+    int events = detector.update(value, dt);
+    if (events != EVENT_NONE) {
+        publishEvent(name, events, value, detector);
+        // Events during a boost must not keep it and bursts going.
+        if (isBoosted(ch) == false) {
+            boostChannel(ch);
+            burst.trigger(1u << ch, burst_window);
         }
-        else tmp = NAN;
-        publishSensorData(tmp_topic, "Temperature", tmp);
-        std::this_thread::sleep_for(1s);
     }
+
+    publishSensorData(topic, name, value);
 }
 
-void readODO() {
-    ODOSensor ODO;
-    int response_time = ODO.getResponseTime();
+// Convert, check and publish a sensor channel forever.
+void monitor(Vernier &sensor, int ch, const char *topic, const char *name,
+             Detector &detector, float &value) {
+    int response_time = sensor.getResponseTime();
     std::this_thread::sleep_for(seconds(response_time));
 
+    Frame last;
     while (true) {
-        float vout = getVout(ODO_CH);
-        if (vout > 0.0) {
-            odo = ODO.readSensor(vout);
-        }
-        else vout = NAN;
-        publishSensorData(odo_topic, "Dissolved oxygen", odo);
-        std::this_thread::sleep_for(1s);
+        checkSensor(sensor, ch, topic, name, detector, value, last);
+        std::this_thread::sleep_for(channelPeriod(ch, normal_period));
     }
 }
 
+void readTemp() {
+    SSTempSensor TMP;
+    Detector detector(tmp_rate_limit, tmp_min_std);
+    monitor(TMP, TMP_CH, tmp_topic, "Temperature", detector, tmp);
+}
+
+void readODO() {
+    ODOSensor ODO;
+    Detector detector(odo_rate_limit, odo_min_std);
+    monitor(ODO, ODO_CH, odo_topic, "Dissolved oxygen", detector, odo);
+}
+
 void readFPH() {
     FPHSensor FPH;
-    int response_time = FPH.getResponseTime();
-    std::this_thread::sleep_for(seconds(response_time));
+    Detector detector(fph_rate_limit, fph_min_std);
+    monitor(FPH, FPH_CH, fph_topic, "pH", detector, fph);
+}
 
-    while (true) {
-        float vout = getVout(FPH_CH);
-        if (vout > 0.0) {
-            fph = FPH.readSensor(vout);
+int readVoltage() {
+    static auto last = steady_clock::now();
+
+    voltage_avg_mutex.lock();
+    int passes = sampler.plan();
+    int first, number;
+    for (int pass = 0; pass < passes; pass++) {
+        sampler.getSpan(pass, first, number);
+        if (ADC.readVoltage(first + 1, number, voltage_read.data()) < 0) {
+            voltage_avg_mutex.unlock();
+            return -1;
         }
-        else fph = NAN;
-        publishSensorData(fph_topic, "pH", fph);
-        std::this_thread::sleep_for(1s);
+        sampler.add(pass, first, number, voltage_read.data());
     }
+    auto now = steady_clock::now();
+    sampler.finish(duration<float>(now - last).count(), voltage_avg.data());
+    last = now;
+    voltage_frame.seq++;
+    voltage_frame.time = now;
+    voltage_avg_mutex.unlock();
+    return 0;
 }
 
-void readVoltage() {
+// Run a pending burst capture and upload it as one block.
+// The block is too large for a publish slot, so it bypasses the lanes;
+// it is dropped while the uplink is down or an earlier block is unsent.
+void runBurst() {
+    if (publisher.canPublishBlock() == false) {
+        burst.cancel();
+        console.error("Uplink busy or down, burst dropped.");
+        return;
+    }
+    int frames = burst.capture(ADC);
+    if (frames <= 0) {
+        console.error("Burst capture failed.");
+        return;
+    }
+    size_t size = burst.encode();
+    if (publisher.publishBlock(matrix752, burst_topic, burst.getBlock(),
+                               size, 1) == 0) {
+        console.print("Burst of %d frames uploaded (%zu bytes)",
+                      frames, size);
+    }
+    else console.error("Burst upload failed.");
+}
+
+// Publish power figures once per power_report.
+void reportPower(const char *mode) {
+    if (power.getElapsed() < duration<double>(power_report).count()) {
+        return;
+    }
+    char msg[MSG_MAX];
+    int len = power.report(mode, msg, sizeof(msg));
+    if (len < 0) {
+        return;
+    }
+    queueMessage(Lane::routine, power_topic, msg, len, 1);
+    console.print("Publish: %lu sent, %lu dropped, %lu coalesced",
+                  publisher.getSent(), publisher.getDropped(),
+                  publisher.getCoalesced());
+}
+
+// Run one acquisition cycle and hand it to local consumers.
+void acquire() {
+    if (burst.pending()) {
+        runBurst();
+    }
+    bool fresh = readVoltage() == 0;
     voltage_avg_mutex.lock();
-    std::fill(voltage_avg.begin(), voltage_avg.end(), 0);
+    if (fresh) {
+        feed.publish(voltage_avg.data(), read_num);
+    }
+    char line[LOG_LINE_MAX];
+    int len = snprintf(line, sizeof(line),
+                       "Average voltage read:\n\tCH1\tCH2\tCH3\tCH4\n");
+    for (const auto &v : voltage_avg) {
+        if (len < (int) sizeof(line)) {
+            len += snprintf(line + len, sizeof(line) - len, "\t%.2g", v);
+        }
+    }
+    voltage_avg_mutex.unlock();
+    console.print("%s", line);
+#ifdef STATIC_MEM
+    long growth = heapguard::checkGrowth();
+    if (growth > 0) {
+        console.error("Heap grew %ld bytes since init (%lu allocations), "
+                      "RSS %ld kB", growth, heapguard::getCount(),
+                      heapguard::getRSS());
+    }
+#endif
+}
+
+// Drain the publish stage off the acquisition path.
+void publishLoop() {
+    while (true) {
+        publisher.wait(1000);
+        publisher.drain(matrix752);
+    }
+}
+
+// Write the console log, so a slow terminal stalls neither acquisition
+// nor MQTT. Sleeps until a line is queued, then paces by log_rate.
+void logLoop() {
+    while (true) {
+        console.wait();
+        console.flush();
+        while (console.pending()) {
+            std::this_thread::sleep_for(milliseconds(1000 / log_rate));
+            console.flush();
+        }
+    }
+}
 
-    for (int i = 0; i < sample_rate; i++){
-        std::vector<float> voltage_read = ADC.readVoltage(1, read_num);
-        if (voltage_read.empty()) {
+// Start a non-blocking reconnect and back off before the next one.
+// Return true if the attempt was started.
+bool startReconnect() {
+    auto now = steady_clock::now();
+    reconnect_at = now + reconnect_backoff;
+    reconnect_backoff = std::min<steady_clock::duration>(2 * reconnect_backoff,
+                                                         reconnect_max);
+    return matrix752.reconnect_async() == MOSQ_ERR_SUCCESS;
+}
+
+// Exchange queued MQTT traffic, for at most mqtt_window. While the
+// uplink is down, at most one reconnect is started per window and the
+// window ends as soon as it fails; messages wait in the publish lanes.
+void flushMqtt() {
+    auto end = steady_clock::now() + mqtt_window;
+    if (publisher.isConnected() == false) {
+        if (steady_clock::now() >= reconnect_at) {
+            connecting = startReconnect();
+        }
+        if (connecting == false) {
+            console.flush();
             return;
         }
-        std::transform(voltage_avg.begin(), voltage_avg.end(),
-                       voltage_read.begin(),
-                       voltage_avg.begin(), std::plus<float>());
     }
-    // Calculate averages
-    for (auto &v : voltage_avg) {
-        v /= sample_rate;
+    int sent;
+    do {
+        sent = publisher.drain(matrix752);
+        if (matrix752.loop(mqtt_poll, 1) != MOSQ_ERR_SUCCESS) {
+            connecting = false;
+            break;
+        }
+    } while ((sent > 0 || matrix752.want_write()
+              || publisher.isConnected() == false)
+             && steady_clock::now() < end);
+    if (publisher.isConnected()) {
+        connecting = false;
+        reconnect_backoff = reconnect_min;
+        // Collect acknowledgements of what was just sent.
+        matrix752.loop(mqtt_poll, 1);
+    }
+    console.flush();
+}
+
+// Sleep until the next multiple of period on the wall clock.
+void sleepAligned(steady_clock::duration period) {
+    long long step = duration_cast<nanoseconds>(period).count();
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    long long now = (long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
+    long long next = (now / step + 1) * step;
+    ts.tv_sec = next / 1000000000;
+    ts.tv_nsec = next % 1000000000;
+    // Only a signal handler can cut the sleep short; retry then.
+    int err;
+    do {
+        err = clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL);
+    } while (err == EINTR);
+    if (err != 0) {
+        console.error("Cannot sleep: %s", strerror(err));
+        std::this_thread::sleep_for(period);
+    }
+}
+
+/* Low-power mode: a single thread wakes on aligned period boundaries,
+   acquires, converts and publishes everything, flushes MQTT and sleeps
+   again. The connection stays idle in between; keepalive covers it.
+*/
+void runLowPower(seconds period) {
+    SSTempSensor TMP;
+    ODOSensor ODO;
+    FPHSensor FPH;
+    Detector tmp_detector(tmp_rate_limit, tmp_min_std);
+    Detector odo_detector(odo_rate_limit, odo_min_std);
+    Detector fph_detector(fph_rate_limit, fph_min_std);
+
+    Frame tmp_last, odo_last, fph_last;
+
+    auto start = steady_clock::now();
+    // main() started the first connection.
+    connecting = true;
+    reconnect_at = start + reconnect_backoff;
+    while (true) {
+        sleepAligned(acquisitionPeriod(period));
+        power.beginActive();
+        // Take in commands received while asleep.
+        matrix752.loop(0, 1);
+        acquire();
+
+        // Skip sensors still within their response time after start.
+        auto uptime = steady_clock::now() - start;
+        if (uptime >= seconds(TMP.getResponseTime())) {
+            checkSensor(TMP, TMP_CH, tmp_topic, "Temperature",
+                        tmp_detector, tmp, tmp_last);
+        }
+        if (uptime >= seconds(ODO.getResponseTime())) {
+            checkSensor(ODO, ODO_CH, odo_topic, "Dissolved oxygen",
+                        odo_detector, odo, odo_last);
+        }
+        if (uptime >= seconds(FPH.getResponseTime())) {
+            checkSensor(FPH, FPH_CH, fph_topic, "pH",
+                        fph_detector, fph, fph_last);
+        }
+        reportPower("low-power");
+        flushMqtt();
+        power.endActive();
     }
-    voltage_avg_mutex.unlock();
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    int low_power = 0;          // Window period in seconds, 0 if disabled
+    int opt;
+    char *end;
+    long period;
+    while ((opt = getopt(argc, argv, "l:")) != -1) {
+        switch (opt) {
+        case 'l':
+            errno = 0;
+            period = strtol(optarg, &end, 10);
+            if (errno != 0 || end == optarg || *end != '\0'
+                || period < 1 || period > low_power_max) {
+                std::cerr << "Invalid low-power period: " << optarg
+                          << " (1-" << low_power_max << " s)" << std::endl;
+                return 1;
+            }
+            low_power = period;
+            break;
+        default:
+            std::cerr << "Usage: " << argv[0] << " [-l period]\n"
+                      << "  -l period\tlow-power mode, wake every period seconds"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    voltage_avg.assign(read_num, 0);
+    voltage_read.assign(read_num, 0);
+    sampler.setResponseTime(TMP_CH, SSTempSensor().getResponseTime());
+    sampler.setResponseTime(ODO_CH, ODOSensor().getResponseTime());
+    sampler.setResponseTime(FPH_CH, FPHSensor().getResponseTime());
+
     std::cout << "Connecting to voltage collector..." << std::flush;
     while (ADC.connect(PORT) < 0) {
         std::cout << "." << std::flush;
         std::this_thread::sleep_for(1s);
     }
     std::cout << "done" << std::endl;
+    sampler.setBaud(ADC.getBaud());
 
+    if (feed.open(feed_frames) < 0) {
+        std::cerr << "Cannot create local feed " SHMFEED_NAME << std::endl;
+    }
+
+    // An idle low-power connection must outlive a whole period.
+    int keepalive = std::max(60, 2 * low_power);
     std::cout << "Connecting to server..." << std::flush;
-    while (matrix752.connect_async(SERVER, TCP_PORT) != MOSQ_ERR_SUCCESS) {
+    while (matrix752.connect_async(SERVER, TCP_PORT, keepalive)
+           != MOSQ_ERR_SUCCESS) {
         std::cout << "." << std::flush;
         std::this_thread::sleep_for(1s);
     }
     std::cout << "done" << std::endl;
 
+    if (low_power > 0) {
+#ifdef STATIC_MEM
+        heapguard::seal();
+#endif
+        runLowPower(seconds(low_power));
+    }
+
     matrix752.loop_start();
 
+    std::thread publish_thread(publishLoop);
+    publish_thread.detach();
+
+    std::thread log_thread(logLoop);
+    log_thread.detach();
+
     std::thread temp_reader(readTemp);
     temp_reader.detach();
 
@@ -160,20 +616,18 @@ int main() {
     std::thread fph_reader(readFPH);
     fph_reader.detach();
 
+#ifdef STATIC_MEM
+    heapguard::seal();
+#endif
+
     while (true) {
-        readVoltage();
-        voltage_avg_mutex.lock();
-        std::cout << "Average voltage read:\n"
-                  << "\tCH1\tCH2\tCH3\tCH4\n"
-                  << std::setprecision(2);
-        for (const auto &v : voltage_avg) {
-            std::cout << "\t" << v;
-        }
-        std::cout << std::endl;
-        voltage_avg_mutex.unlock();
-        std::this_thread::sleep_for(1s);
+        power.beginActive();
+        acquire();
+        reportPower("normal");
+        power.endActive();
+        std::this_thread::sleep_for(acquisitionPeriod(normal_period));
     }
 
     matrix752.loop_stop();
     mosqpp::lib_cleanup();
-}
\ No newline at end of file
+}
@@ -0,0 +1,71 @@
+#include "power.hpp"
+#include <cstdio>
+#include <sys/resource.h>
+
+using namespace std::chrono;
+
+// Return voluntary context switches of all threads.
+static long getSwitches() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw;
+}
+
+// Return CPU seconds used by all threads.
+static double getCPU() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+         + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void PowerStats::reset() {
+    start = steady_clock::now();
+    active = steady_clock::duration::zero();
+    if (in_active) {
+        active_start = start;
+    }
+    switches = getSwitches();
+    cpu = getCPU();
+}
+
+void PowerStats::beginActive() {
+    active_start = steady_clock::now();
+    in_active = true;
+}
+
+void PowerStats::endActive() {
+    if (in_active) {
+        active += steady_clock::now() - active_start;
+        in_active = false;
+    }
+}
+
+double PowerStats::getElapsed() {
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+int PowerStats::report(const char *mode, char *msg, size_t size) {
+    auto now = steady_clock::now();
+    double elapsed = duration<double>(now - start).count();
+    auto busy = active;
+    if (in_active) {
+        busy += now - active_start;
+    }
+    if (elapsed <= 0) {
+        elapsed = 1e-9;
+    }
+
+    int len = snprintf(msg, size,
+                       "{\"mode\":\"%s\",\"period\":%.1f,"
+                       "\"wakeups\":%.2f,\"active\":%.2f,\"cpu\":%.2f}",
+                       mode, elapsed,
+                       (getSwitches() - switches) / elapsed,
+                       100 * duration<double>(busy).count() / elapsed,
+                       100 * (getCPU() - cpu) / elapsed);
+    reset();
+    if (len < 0 || len >= (int) size) {
+        return -1;
+    }
+    return len;
+}
@@ -0,0 +1,239 @@
+#include "publisher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+Publisher::Publisher(size_t event_slots, size_t routine_slots, size_t topics,
+                     size_t window, Overflow event_policy,
+                     Overflow routine_policy)
+    : events(event_slots), routine(routine_slots),
+      event_policy(event_policy), routine_policy(routine_policy),
+      latest(topics), connected(false),
+      window(std::max(window, (size_t) 1)),
+      sent(0), dropped(0), coalesced(0) {
+    inflight.reserve(this->window);
+    early.reserve(this->window);
+    sem_init(&ready, 0, 0);
+}
+
+Publisher::~Publisher() {
+    sem_destroy(&ready);
+}
+
+void Publisher::notify() {
+    // One pending wakeup is enough, the consumer drains everything.
+    int value;
+    if (sem_getvalue(&ready, &value) == 0 && value > 0) {
+        return;
+    }
+    sem_post(&ready);
+}
+
+void Publisher::wait(int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&ready, &ts) < 0 && errno == EINTR) {}
+}
+
+int Publisher::enqueue(BoundedQueue<PublishMessage> &lane, Overflow policy,
+                       const PublishMessage &message) {
+    if (lane.push(message)) {
+        return 0;
+    }
+    if (policy == Overflow::drop_newest) {
+        dropped++;
+        return -1;
+    }
+    // Drop the oldest; coalescing lanes only fill up while the consumer
+    // is not running at all, so the newest values win there as well.
+    PublishMessage oldest;
+    int rc = 0;
+    if (lane.pop(oldest)) {
+        dropped++;
+        rc = 1;
+    }
+    if (lane.push(message) == false) {
+        dropped++;
+        return -1;
+    }
+    return rc;
+}
+
+int Publisher::push(Lane lane, const char *topic, const char *payload,
+                    int len, int qos) {
+    if (len < 0 || len > PUBLISH_PAYLOAD_MAX) {
+        dropped++;
+        return -1;
+    }
+    PublishMessage message;
+    message.topic = topic;
+    message.qos = qos;
+    message.len = len;
+    memcpy(message.payload, payload, len);
+
+    int rc = lane == Lane::event
+           ? enqueue(events, event_policy, message)
+           : enqueue(routine, routine_policy, message);
+    if (rc >= 0) {
+        notify();
+    }
+    return rc;
+}
+
+void Publisher::coalesce(const PublishMessage &message) {
+    for (size_t i = 0; i < latest_used; i++) {
+        if (latest[i].topic == message.topic) {
+            latest[i] = message;
+            coalesced++;
+            return;
+        }
+    }
+    if (latest_used < latest.size()) {
+        latest[latest_used++] = message;
+    }
+    else dropped++;
+}
+
+bool Publisher::next(PublishMessage &message) {
+    if (events.pop(message)) {
+        return true;
+    }
+    // Coalesced values are older than anything still in the lane.
+    if (latest_used > 0) {
+        message = latest[0];
+        latest_used--;
+        std::copy(latest.begin() + 1, latest.begin() + latest_used + 1,
+                  latest.begin());
+        return true;
+    }
+    return routine.pop(message);
+}
+
+bool Publisher::hasRoom() {
+    std::lock_guard<std::mutex> lock(inflight_mutex);
+    return inflight.size() < window;
+}
+
+int Publisher::drain(mosqpp::mosquittopp &client) {
+    int count = 0;
+    bool backed_up = false;
+    PublishMessage message;
+
+    while (true) {
+        if (connected.load() == false || hasRoom() == false) {
+            backed_up = true;
+            break;
+        }
+        if (next(message) == false) {
+            break;
+        }
+        int mid;
+        int rc = client.publish(&mid, message.topic, message.len,
+                                message.payload, message.qos);
+        if (rc == MOSQ_ERR_NO_CONN) {
+            // Lost the connection meanwhile. The client still keeps QoS 1/2
+            // messages for its reconnect, so only QoS 0 ones are lost.
+            if (message.qos > 0) {
+                sent++;
+                count++;
+            }
+            else dropped++;
+            backed_up = true;
+            break;
+        }
+        if (rc != MOSQ_ERR_SUCCESS) {
+            dropped++;
+            continue;
+        }
+        if (message.qos > 0) {
+            track(mid);
+        }
+        sent++;
+        count++;
+    }
+
+    // While backed up, keep only the newest routine value of each topic.
+    if (backed_up && routine_policy == Overflow::coalesce) {
+        while (routine.pop(message)) {
+            coalesce(message);
+        }
+    }
+    return count;
+}
+
+bool Publisher::canPublishBlock() {
+    std::lock_guard<std::mutex> lock(inflight_mutex);
+    return connected.load() && block_mid == 0;
+}
+
+int Publisher::publishBlock(mosqpp::mosquittopp &client, const char *topic,
+                            const void *data, int len, int qos) {
+    if (canPublishBlock() == false) {
+        return -1;
+    }
+    int mid;
+    int rc = client.publish(&mid, topic, len, data, qos);
+    if (rc != MOSQ_ERR_SUCCESS && (rc != MOSQ_ERR_NO_CONN || qos == 0)) {
+        return -1;
+    }
+    if (qos > 0) {
+        std::lock_guard<std::mutex> lock(inflight_mutex);
+        if (takeEarly(mid) == false) {
+            block_mid = mid;
+        }
+    }
+    return 0;
+}
+
+bool Publisher::takeEarly(int mid) {
+    auto it = std::find(early.begin(), early.end(), mid);
+    if (it == early.end()) {
+        return false;
+    }
+    early.erase(it);
+    return true;
+}
+
+void Publisher::track(int mid) {
+    std::lock_guard<std::mutex> lock(inflight_mutex);
+    if (takeEarly(mid) == false) {
+        inflight.push_back(mid);
+    }
+}
+
+void Publisher::acknowledge(int mid) {
+    std::lock_guard<std::mutex> lock(inflight_mutex);
+    if (mid == block_mid) {
+        block_mid = 0;
+        return;
+    }
+    auto it = std::find(inflight.begin(), inflight.end(), mid);
+    if (it != inflight.end()) {
+        inflight.erase(it);
+        notify();
+        return;
+    }
+    // Acknowledged before drain() got to track it.
+    if (early.size() == window) {
+        early.erase(early.begin());
+    }
+    early.push_back(mid);
+}
+
+void Publisher::setConnected(bool up) {
+    connected.store(up);
+    if (up == false) {
+        // The block stays with the client, which resends it on reconnect.
+        std::lock_guard<std::mutex> lock(inflight_mutex);
+        inflight.clear();
+        early.clear();
+    }
+    notify();
+}
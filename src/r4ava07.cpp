@@ -1,12 +1,12 @@
 #include "r4ava07.hpp"
+#include "baudrate.hpp"
 #include <arpa/inet.h>
 #include <fcntl.h>
-#include <map>
-#include <stdexcept>
 
 #define BROADCAST 0xFF
 #define ID_MAX 247
 #define CH_MAX 7
+#define BAUD_CODE_MAX 4
 
 #ifdef DEBUG
 #include <cerrno>
@@ -28,13 +28,6 @@ enum class Registers : uint16_t {
 };
 
 unsigned short read_data[7] = {0x00};
-std::map<short, uint16_t> baudrates {
-    {1200, 0},
-    {2400, 1},
-    {4800, 2},
-    {9600, 3},
-    {19200, 4}
-};
 
 bool R4AVA07::isValid(short ch) {
     return (ch >= 1 && ch <= CH_MAX);
@@ -68,47 +61,61 @@ int R4AVA07::connect(const char *port) {
     return modbus_get_socket(ctx);
 }
 
-std::vector<float>  R4AVA07::readVoltage(uint16_t ch, uint8_t number) {
+int R4AVA07::readVoltage(uint16_t ch, uint8_t number, float *voltage) {
     if (isValid(ch) == false) {
         DEBUG_PRINT("Invalid channel: " << ch);
-        return {-1};
+        return -1;
     }
     if (isValid(ch + number -1) == false) {
         DEBUG_PRINT("Invalid read number: " << number);
-        return {-1};
+        return -1;
     }
     // Channel 1-7 indicated at 0x0000-0x0006.
     if (modbus_read_registers(ctx, (ch-1) << 16, number, read_data) < 1) {
         DEBUG_PRINT("Cannot read voltage values.");
-        return {-1};
+        return -1;
     }
-    std::vector<float> voltage;
     for (auto i = 0; i < number; i++) {
-        voltage.push_back((float) read_data[i] / 100.0);
+        voltage[i] = (float) read_data[i] / 100.0;
     }
-    return voltage;
+    return number;
 }
 
-std::vector<float> R4AVA07::getVoltageRatio(uint16_t ch,
-                                            uint8_t number) {
+int R4AVA07::getVoltageRatio(uint16_t ch, uint8_t number, float *ratio) {
     if (isValid(ch) == false) {
         DEBUG_PRINT("Invalid channel: " << ch);
-        return {-1};
+        return -1;
     }
     if (isValid(ch + number -1) == false) {
         DEBUG_PRINT("Invalid read number: " << number);
-        return {-1};
+        return -1;
     }
     // Channel 1-7 indicated at 0x0007-0x000D.
     if (modbus_read_registers(ctx, ch + 6, number, read_data) < 1) {
         DEBUG_PRINT("Cannot read voltage ratios.");
-        return {-1};
+        return -1;
     }
-    std::vector<float> ratio;
     for (auto i = 0; i < number; i++) {
-        ratio.push_back((float) read_data[i] / 1000.0);
+        ratio[i] = (float) read_data[i] / 1000.0;
+    }
+    return number;
+}
+
+std::vector<float>  R4AVA07::readVoltage(uint16_t ch, uint8_t number) {
+    float voltage[CH_MAX];
+    if (readVoltage(ch, number, voltage) < 0) {
+        return {-1};
     }
-    return ratio;
+    return std::vector<float>(voltage, voltage + number);
+}
+
+std::vector<float> R4AVA07::getVoltageRatio(uint16_t ch,
+                                            uint8_t number) {
+    float ratio[CH_MAX];
+    if (getVoltageRatio(ch, number, ratio) < 0) {
+        return {-1};
+    }
+    return std::vector<float>(ratio, ratio + number);
 }
 
 int R4AVA07::setID(short newID) {
@@ -137,11 +144,8 @@ int R4AVA07::setVoltageRatio(short ch, float ratio) {
 }
 
 int R4AVA07::setBaudRate(uint16_t target_baud) {
-    uint16_t baud_code;
-    try {
-        baud_code = baudrates.at(target_baud);
-    }
-    catch (const std::out_of_range &e) {
+    int baud_code = baudCode(target_baud, BAUD_CODE_MAX);
+    if (baud_code < 0) {
         DEBUG_PRINT("Not supported baud rate");
         return -1;
     }
@@ -0,0 +1,279 @@
+#include "rtu.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <poll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifdef DEBUG
+#include <iostream>
+
+#define DEBUG_PRINT(MSG)               \
+{                                      \
+    std::cerr << __func__ << ", line " \
+              << __LINE__ << ":\t"     \
+              << MSG << "\n";          \
+}
+#else
+#define DEBUG_PRINT(MSG)
+#endif
+
+#define CRC_POLY 0xA001         // Reflected 0x8005
+#define FUNC_READ 0x03
+#define FUNC_ERROR 0x80
+#define CHAR_BITS 11            // Start, 8 data, parity or stop, stop
+#define FAST_SILENCE_US 1750    // Fixed t3.5 above 19200 baud
+
+// Slice-by-8 lookup tables, built before main().
+static struct CRCTables {
+    uint16_t t[8][256];
+
+    CRCTables() {
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC_POLY : crc >> 1;
+            }
+            t[0][i] = crc;
+        }
+        for (int i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xFF];
+            }
+        }
+    }
+} tables;
+
+uint16_t rtuCRC(const uint8_t *data, size_t len, uint16_t crc) {
+    const uint16_t (*t)[256] = tables.t;
+    while (len >= 8) {
+        uint16_t lo = crc ^ (data[0] | data[1] << 8);
+        crc = t[7][lo & 0xFF] ^ t[6][lo >> 8]
+            ^ t[5][data[2]] ^ t[4][data[3]]
+            ^ t[3][data[4]] ^ t[2][data[5]]
+            ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+// Return monotonic time in microseconds.
+static int64_t now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int RtuRing::fill(int fd) {
+    size_t room = RTU_RING_SIZE - size();
+    if (room == 0) {
+        return 0;
+    }
+    // Read straight into the free space, which may wrap around.
+    size_t start = tail & (RTU_RING_SIZE - 1);
+    size_t first = std::min(room, RTU_RING_SIZE - start);
+    struct iovec iov[2] = {
+        {buf + start, first},
+        {buf, room - first},
+    };
+    ssize_t n = readv(fd, iov, room > first ? 2 : 1);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    tail += n;
+    return n;
+}
+
+uint16_t RtuRing::crc(size_t len) {
+    size_t start = head & (RTU_RING_SIZE - 1);
+    size_t first = std::min(len, RTU_RING_SIZE - start);
+    uint16_t crc = rtuCRC(buf + start, first);
+    return rtuCRC(buf, len - first, crc);
+}
+
+void RtuMaster::attach(int new_fd, uint32_t baud, uint8_t new_addr) {
+    fd = new_fd;
+    addr = new_addr;
+    setBaud(baud);
+    state = RtuState::idle;
+    ring.clear();
+}
+
+void RtuMaster::setBaud(uint32_t baud) {
+    char_us = (CHAR_BITS * 1000000 + baud - 1) / baud;
+    silence_us = baud > 19200 ? FAST_SILENCE_US : (7 * char_us + 1) / 2;
+}
+
+RtuState RtuMaster::fail(int code) {
+    DEBUG_PRINT("Transaction failed: " << code);
+    error = code;
+    state = RtuState::failed;
+    return state;
+}
+
+int RtuMaster::requestRead(uint16_t reg, uint16_t count) {
+    if (fd < 0 || state == RtuState::sending || state == RtuState::waiting) {
+        return -1;
+    }
+    if (count == 0 || 5 + 2 * count > RTU_FRAME_MAX) {
+        DEBUG_PRINT("Invalid read number: " << count);
+        return -1;
+    }
+
+    request[0] = addr;
+    request[1] = FUNC_READ;
+    request[2] = reg >> 8;
+    request[3] = reg & 0xFF;
+    request[4] = count >> 8;
+    request[5] = count & 0xFF;
+    uint16_t crc = rtuCRC(request, 6);
+    request[6] = crc & 0xFF;
+    request[7] = crc >> 8;
+
+    // Late bytes of an earlier transaction must not be taken as ours.
+    tcflush(fd, TCIFLUSH);
+    ring.clear();
+    number = count;
+    sent = 0;
+    error = 0;
+    state = RtuState::sending;
+    return 0;
+}
+
+RtuState RtuMaster::parse() {
+    // Skip line noise ahead of our slave's address.
+    while (ring.size() > 0 && ring.at(0) != addr) {
+        ring.consume(1);
+    }
+    if (ring.size() < 2) {
+        return state;
+    }
+
+    size_t len;
+    uint8_t func = ring.at(1);
+    if (func == (FUNC_READ | FUNC_ERROR)) {
+        len = 5;
+    }
+    else if (func == FUNC_READ) {
+        if (ring.size() >= 3 && ring.at(2) != 2 * number) {
+            return fail(-EBADMSG);
+        }
+        len = 5 + 2 * number;
+    }
+    else return fail(-EBADMSG);
+
+    if (ring.size() < len) {
+        return state;
+    }
+    uint16_t crc = ring.at(len - 2) | ring.at(len - 1) << 8;
+    if (ring.crc(len - 2) != crc) {
+        return fail(-EBADMSG);
+    }
+    if (func != FUNC_READ) {
+        return fail(ring.at(2));
+    }
+    state = RtuState::done;
+    return state;
+}
+
+RtuState RtuMaster::poll() {
+    int64_t now = now_us();
+
+    if (state == RtuState::sending) {
+        // Keep the bus silent for t3.5 before a new frame.
+        if (now < last_byte + silence_us) {
+            return state;
+        }
+        ssize_t n = write(fd, request + sent, sizeof(request) - sent);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return state;
+            }
+            return fail(-EIO);
+        }
+        sent += n;
+        if (sent == sizeof(request)) {
+            // The UART still has to shift the frame out.
+            last_byte = now + sizeof(request) * char_us;
+            deadline = last_byte + timeout_us;
+            state = RtuState::waiting;
+        }
+        return state;
+    }
+
+    if (state == RtuState::waiting) {
+        int n = ring.fill(fd);
+        if (n < 0) {
+            return fail(-EIO);
+        }
+        if (n > 0) {
+            last_byte = now;
+            parse();
+        }
+        else if (ring.size() > 0 && now > last_byte + byte_timeout_us) {
+            // The slave stopped mid-frame.
+            return fail(-ETIMEDOUT);
+        }
+        if (state == RtuState::waiting && now > deadline) {
+            return fail(-ETIMEDOUT);
+        }
+    }
+    return state;
+}
+
+int64_t RtuMaster::getWait() {
+    int64_t now = now_us();
+    if (state == RtuState::sending) {
+        return std::max<int64_t>(last_byte + silence_us - now, 0);
+    }
+    if (state == RtuState::waiting) {
+        int64_t until = deadline;
+        if (ring.size() > 0) {
+            until = std::min<int64_t>(until, last_byte + byte_timeout_us);
+        }
+        return std::max<int64_t>(until - now, 0);
+    }
+    return -1;
+}
+
+int RtuMaster::getRegisters(uint16_t *dest) {
+    if (state != RtuState::done) {
+        return -1;
+    }
+    for (int i = 0; i < number; i++) {
+        dest[i] = ring.word(3 + 2 * i);
+    }
+    return number;
+}
+
+int RtuMaster::readRegisters(uint16_t reg, uint16_t count, uint16_t *dest) {
+    if (requestRead(reg, count) < 0) {
+        return -1;
+    }
+    while (true) {
+        RtuState st = poll();
+        if (st == RtuState::done) {
+            return getRegisters(dest);
+        }
+        if (st == RtuState::failed) {
+            return -1;
+        }
+
+        int64_t wait = getWait();
+        struct pollfd pfd = {fd, 0, 0};
+        pfd.events = st == RtuState::sending ? POLLOUT : POLLIN;
+        // Waiting out the silence must not wake on a writable port.
+        if (st == RtuState::sending && wait > 0) {
+            pfd.events = 0;
+        }
+        struct timespec ts = {(time_t) (wait / 1000000),
+                              (long) (wait % 1000000) * 1000};
+        ppoll(&pfd, 1, &ts, NULL);
+    }
+}
@@ -0,0 +1,119 @@
+#include "sampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Modbus RTU bytes of one read request and response, without data.
+#define FRAME_BYTES 13
+#define REG_BYTES 2
+// Bus timing of a transaction: t3.5 silence before request and response,
+// fixed above 19200 baud, and the slave's time to start answering.
+#define CHAR_BITS 11
+#define FAST_SILENCE_US 1750
+#define TURNAROUND_US 1000
+// Smoothing of the noise estimate, per cycle.
+#define NOISE_ALPHA 0.2
+
+Sampler::Sampler(int channels, int full_reads, int max_reads, float target)
+    : channels(channels), full_reads(full_reads),
+      min_reads(2), max_reads(std::max(max_reads, 2)), target(target),
+      noise(channels, 0), rate(channels, 0), tau(channels, 1),
+      last(channels, NAN), reads(channels, full_reads),
+      sum(channels, 0), sum_sq(channels, 0), count(channels, 0) {
+    setBaud(9600);
+}
+
+void Sampler::setBaud(uint32_t baud) {
+    float char_us = CHAR_BITS * 1e6f / std::max(baud, 1u);
+    float silence = baud > 19200 ? FAST_SILENCE_US / char_us : 3.5f;
+    overhead = std::ceil(2 * silence + TURNAROUND_US / char_us);
+    budget = full_reads * passCost(channels);
+}
+
+void Sampler::setResponseTime(int ch, float seconds) {
+    tau[ch] = std::max(seconds, 1.0f);
+}
+
+int Sampler::passCost(int number) {
+    return FRAME_BYTES + REG_BYTES * number + overhead;
+}
+
+int Sampler::cost() {
+    int chars = 0;
+    int first, number;
+    for (int pass = 0; getSpan(pass, first, number); pass++) {
+        chars += passCost(number);
+    }
+    return chars;
+}
+
+int Sampler::plan() {
+    for (int ch = 0; ch < channels; ch++) {
+        sum[ch] = sum_sq[ch] = 0;
+        count[ch] = 0;
+        // A ramp over the cycle adds its spread to the read noise.
+        float ramp = rate[ch] * period;
+        float drift = ramp * ramp / 12;
+        int need = std::ceil((noise[ch] + drift) / (target * target));
+        reads[ch] = std::min(std::max(need, min_reads), max_reads);
+    }
+    // Trim the hungriest channel until the plan fits the bus budget.
+    while (cost() > budget) {
+        auto most = std::max_element(reads.begin(), reads.end());
+        if (*most <= min_reads) {
+            break;
+        }
+        (*most)--;
+    }
+    return *std::max_element(reads.begin(), reads.end());
+}
+
+bool Sampler::getSpan(int pass, int &first, int &number) {
+    first = -1;
+    int end = -1;
+    for (int ch = 0; ch < channels; ch++) {
+        if (reads[ch] > pass) {
+            if (first < 0) {
+                first = ch;
+            }
+            end = ch;
+        }
+    }
+    number = end - first + 1;
+    return first >= 0;
+}
+
+void Sampler::add(int pass, int first, int number, const float *voltage) {
+    for (int i = 0; i < number; i++) {
+        int ch = first + i;
+        if (reads[ch] > pass) {
+            sum[ch] += voltage[i];
+            sum_sq[ch] += voltage[i] * voltage[i];
+            count[ch]++;
+        }
+    }
+}
+
+void Sampler::finish(float dt, float *average) {
+    for (int ch = 0; ch < channels; ch++) {
+        int n = count[ch];
+        if (n > 0) {
+            double mean = sum[ch] / n;
+            if (n > 1) {
+                double var = std::max((sum_sq[ch] - n * mean * mean) / (n - 1),
+                                      0.0);
+                noise[ch] += NOISE_ALPHA * (var - noise[ch]);
+            }
+            if (std::isnan(last[ch]) == false && dt > 0) {
+                // Changes faster than the sensor's response are smoothed out.
+                float alpha = dt / (tau[ch] + dt);
+                float change = (mean - last[ch]) / dt;
+                rate[ch] += alpha * (change - rate[ch]);
+            }
+            last[ch] = mean;
+            average[ch] = mean;
+        }
+    }
+    if (dt > 0) {
+        period = dt;
+    }
+}
@@ -0,0 +1,90 @@
+#include "shmfeed.hpp"
+#include <algorithm>
+#include <ctime>
+
+#ifdef DEBUG
+#include <cerrno>
+#include <iostream>
+
+#define DEBUG_PRINT(MSG)               \
+{                                      \
+    std::cerr << __func__ << ", line " \
+              << __LINE__ << ":\t"     \
+              << MSG << "\n";          \
+}
+#else
+#define DEBUG_PRINT(MSG)
+#endif
+
+ShmFeedWriter::~ShmFeedWriter() {
+    if (map != MAP_FAILED) {
+        munmap(map, map_size);
+    }
+}
+
+int ShmFeedWriter::open(uint32_t capacity, const char *name) {
+    if (capacity < 2) {
+        DEBUG_PRINT("Invalid capacity: " << capacity);
+        return -1;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        DEBUG_PRINT("Cannot open shared memory: " << strerror(errno));
+        return -1;
+    }
+    map_size = sizeof(ShmHeader) + capacity * sizeof(ShmSlot);
+    if (ftruncate(fd, map_size) < 0) {
+        DEBUG_PRINT("Cannot size shared memory: " << strerror(errno));
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        DEBUG_PRINT("Cannot map shared memory: " << strerror(errno));
+        return -1;
+    }
+
+    // Invalidate the header while rebuilding the ring. Readers of a
+    // previous run hold on until the generation is even again.
+    header = (ShmHeader *) map;
+    uint32_t generation = header->generation.load(std::memory_order_relaxed);
+    generation = (generation + 1) | 1;
+    header->magic = 0;
+    header->generation.store(generation, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slots = (ShmSlot *) (header + 1);
+    memset((void *) slots, 0, capacity * sizeof(ShmSlot));
+    header->version = SHMFEED_VERSION;
+    header->capacity = capacity;
+    header->slot_size = sizeof(ShmSlot);
+    header->head.store(0, std::memory_order_relaxed);
+    header->generation.store(generation + 1, std::memory_order_release);
+    header->magic = SHMFEED_MAGIC;
+    return 0;
+}
+
+void ShmFeedWriter::publish(const float *voltage, uint32_t channels) {
+    if (slots == nullptr) {
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    seq++;
+    uint32_t index = seq % header->capacity;
+    ShmSlot &slot = slots[index];
+    uint32_t lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frame.seq = seq;
+    slot.frame.timestamp = (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+    slot.frame.channels = std::min(channels, (uint32_t) SHMFEED_CH_MAX);
+    memcpy(slot.frame.voltage, voltage,
+           slot.frame.channels * sizeof(float));
+
+    slot.lock.store(lock + 2, std::memory_order_release);
+    header->head.store(index, std::memory_order_release);
+}